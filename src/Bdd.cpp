@@ -0,0 +1,424 @@
+#include "Bdd.hpp"
+
+#include "Variable.hpp"
+#include "Constant.hpp"
+#include "UnaryOperator.hpp"
+#include "BinaryOperator.hpp"
+
+#include <cassert>
+#include <algorithm>
+
+Bdd::Bdd() : nodeCount(1), createdNodeCount(0), budgetCheckNodeCount(BUDGET_CHECK_INTERVAL), cache(CACHE_SIZE),
+             budget(nullptr), interrupted(false), autoReorder(true), reorderNodeCount(MIN_REORDER_NODE_COUNT) {
+	nodes.push_back({ -1, ONE, ONE });
+	refCounts.push_back(0);
+	clearCache();
+}
+
+void Bdd::setBudget(Budget* budget) {
+	this->budget = budget;
+}
+
+bool Bdd::isInterrupted() const {
+	return interrupted;
+}
+
+void Bdd::setAutoReorder(bool autoReorder) {
+	this->autoReorder = autoReorder;
+}
+
+int Bdd::addVariable() {
+	const int variable = static_cast<int>(levels.size());
+	levels.push_back(variable);
+	variables.push_back(variable);
+	uniqueTables.emplace_back();
+	return variable;
+}
+
+int Bdd::getVariableCount() const {
+	return static_cast<int>(levels.size());
+}
+
+int Bdd::getLevel(int variable) const {
+	return levels[variable];
+}
+
+uint32_t Bdd::getIndex(Edge f) {
+	return f >> 1;
+}
+
+bool Bdd::isComplemented(Edge f) {
+	return (f & 1) != 0;
+}
+
+uint64_t Bdd::getKey(Edge low, Edge high) {
+	return static_cast<uint64_t>(low) << 32 | high;
+}
+
+int Bdd::getEdgeLevel(Edge f) const {
+	const int variable = nodes[getIndex(f)].variable;
+	return variable == -1 ? getVariableCount() : levels[variable];
+}
+
+void Bdd::getCofactors(Edge f, int level, Edge& low, Edge& high) const {
+	if (getEdgeLevel(f) != level) {
+		low = high = f;
+		return;
+	}
+	const Node& node = nodes[getIndex(f)];
+	low = node.low ^ (f & 1);
+	high = node.high ^ (f & 1);
+}
+
+Bdd::Edge Bdd::getNode(int variable, Edge low, Edge high) {
+	if (interrupted)
+		return ZERO;
+	const Edge result = makeNode(variable, low, high);
+	if (createdNodeCount >= budgetCheckNodeCount)
+		checkBudget();
+	return result;
+}
+
+void Bdd::checkBudget() {
+	if (!budget || interrupted)
+		return;
+	const uint64_t steps = createdNodeCount + BUDGET_CHECK_INTERVAL - budgetCheckNodeCount;
+	budgetCheckNodeCount = createdNodeCount + BUDGET_CHECK_INTERVAL;
+	if (budget->isExceeded(steps, nodeCount * NODE_MEMORY))
+		interrupted = true;
+}
+
+Bdd::Edge Bdd::makeNode(int variable, Edge low, Edge high) {
+	if (low == high)
+		return low;
+	const Edge complement = high & 1; // the complement moves to the edge of the node
+	low ^= complement;
+	high ^= complement;
+	auto& uniqueTable = uniqueTables[variable];
+	auto it = uniqueTable.find(getKey(low, high));
+	if (it != uniqueTable.end())
+		return it->second << 1 | complement;
+	uint32_t index;
+	if (freeNodes.empty()) {
+		index = static_cast<uint32_t>(nodes.size());
+		nodes.push_back({ variable, low, high });
+		refCounts.push_back(0);
+	}
+	else {
+		index = freeNodes.back();
+		freeNodes.pop_back();
+		nodes[index] = { variable, low, high };
+		refCounts[index] = 0;
+	}
+	refCounts[getIndex(low)]++;
+	refCounts[getIndex(high)]++;
+	uniqueTable.emplace(getKey(low, high), index);
+	nodeCount++;
+	createdNodeCount++;
+	return index << 1 | complement;
+}
+
+void Bdd::freeNode(uint32_t index) {
+	const Node node = nodes[index];
+	uniqueTables[node.variable].erase(getKey(node.low, node.high));
+	freeNodes.push_back(index);
+	nodeCount--;
+	for (Edge child : { node.low, node.high }) {
+		const uint32_t childIndex = getIndex(child);
+		if (childIndex != 0 && --refCounts[childIndex] == 0)
+			freeNode(childIndex);
+	}
+}
+
+void Bdd::clearCache() {
+	std::fill(cache.begin(), cache.end(), CacheEntry{ ZERO, ZERO, ZERO, ZERO });
+}
+
+Bdd::Edge Bdd::getVariable(int variable) {
+	return getNode(variable, ZERO, ONE);
+}
+
+Bdd::Edge Bdd::negate(Edge f) {
+	return f ^ 1;
+}
+
+Bdd::Edge Bdd::ite(Edge f, Edge g, Edge h) {
+	if (f == ONE)
+		return g;
+	if (f == ZERO)
+		return h;
+	// the branches equal to the condition become constants
+	if (g == f)
+		g = ONE;
+	else if (g == negate(f))
+		g = ZERO;
+	if (h == f)
+		h = ZERO;
+	else if (h == negate(f))
+		h = ONE;
+	if (g == h)
+		return g;
+	if (g == ONE && h == ZERO)
+		return f;
+	if (g == ZERO && h == ONE)
+		return negate(f);
+	// a standard triple per function: the condition and the then branch are not complemented
+	if (isComplemented(f)) {
+		f = negate(f);
+		std::swap(g, h);
+	}
+	Edge complement = 0;
+	if (isComplemented(g)) {
+		complement = 1;
+		g = negate(g);
+		h = negate(h);
+	}
+	const uint64_t hash = (static_cast<uint64_t>(f) * 0x9E3779B97F4A7C15ull) ^
+		(static_cast<uint64_t>(g) * 0xC2B2AE3D27D4EB4Full) ^ (static_cast<uint64_t>(h) * 0x165667B19E3779F9ull);
+	CacheEntry& entry = cache[(hash ^ (hash >> 32)) & (CACHE_SIZE - 1)];
+	if (entry.f == f && entry.g == g && entry.h == h)
+		return entry.result ^ complement;
+
+	const int level = std::min({ getEdgeLevel(f), getEdgeLevel(g), getEdgeLevel(h) });
+	Edge f0, f1, g0, g1, h0, h1;
+	getCofactors(f, level, f0, f1);
+	getCofactors(g, level, g0, g1);
+	getCofactors(h, level, h0, h1);
+	const Edge low = ite(f0, g0, h0);
+	const Edge high = ite(f1, g1, h1);
+	const Edge result = getNode(variables[level], low, high);
+	if (!interrupted)
+		entry = { f, g, h, result };
+	return result ^ complement;
+}
+
+Bdd::Edge Bdd::apply(Edge f, int op, Edge g) {
+	// the bits of op from the highest are the values for (0, 0), (0, 1), (1, 0), (1, 1)
+	auto value = [op](int left, int right) { return ((op >> (3 - left * 2 - right)) & 1) != 0; };
+	auto function = [g](bool value0, bool value1) {
+		if (value0 == value1)
+			return value0 ? ONE : ZERO;
+		return value1 ? g : negate(g);
+	};
+	return ite(f, function(value(1, 0), value(1, 1)), function(value(0, 0), value(0, 1)));
+}
+
+Bdd::Edge Bdd::fromProposition(const PropositionSP& proposition) {
+	std::vector<int> variableIds;
+	proposition->getVariableIds(variableIds);
+	std::sort(variableIds.begin(), variableIds.end());
+	for (int id : variableIds)
+		if (propositionVariables.find(id) == propositionVariables.end())
+			propositionVariables.emplace(id, addVariable());
+	const Edge result = build(proposition);
+	ref(result);
+	return result;
+}
+
+Bdd::Edge Bdd::build(const PropositionSP& proposition) {
+	switch (proposition->getType()) {
+	case Proposition::VARIABLE:
+		return getVariable(propositionVariables.at(std::static_pointer_cast<Variable>(proposition)->getId()));
+	case Proposition::CONSTANT:
+		return std::static_pointer_cast<Constant>(proposition)->getValue() == Constant::TRUE ? ONE : ZERO;
+	case Proposition::UNARY: {
+		auto unary = std::static_pointer_cast<UnaryOperator>(proposition);
+		if (unary->getOp() == UnaryOperator::FALSE || unary->getOp() == UnaryOperator::TRUE)
+			return unary->getOp() == UnaryOperator::TRUE ? ONE : ZERO;
+		const Edge operand = build(unary->getOperand());
+		return unary->getOp() == UnaryOperator::NOT ? negate(operand) : operand;
+	}
+	case Proposition::BINARY:
+		break;
+	}
+	auto binary = std::static_pointer_cast<BinaryOperator>(proposition);
+	// the operands are referenced while the other one is built, which may collect garbage
+	const Edge left = build(binary->getLeft());
+	ref(left);
+	const Edge right = build(binary->getRight());
+	ref(right);
+	if (nodeCount >= reorderNodeCount && !interrupted) {
+		if (autoReorder)
+			reorder();
+		else
+			collectGarbage();
+		reorderNodeCount = nodeCount * 2 > MIN_REORDER_NODE_COUNT ? nodeCount * 2 : MIN_REORDER_NODE_COUNT;
+	}
+	const Edge result = apply(left, binary->getOp(), right);
+	deref(left);
+	deref(right);
+	return result;
+}
+
+void Bdd::ref(Edge f) {
+	if (getIndex(f) != 0)
+		refCounts[getIndex(f)]++;
+}
+
+void Bdd::deref(Edge f) {
+	if (getIndex(f) != 0) {
+		assert(refCounts[getIndex(f)] > 0);
+		refCounts[getIndex(f)]--;
+	}
+}
+
+void Bdd::collectGarbage() {
+	// from the top level down: the children of a freed node are freed with it once unreferenced
+	std::vector<uint32_t> unreferenced;
+	for (int level = 0; level < getVariableCount(); level++) {
+		unreferenced.clear();
+		for (auto& item : uniqueTables[variables[level]])
+			if (refCounts[item.second] == 0)
+				unreferenced.push_back(item.second);
+		for (uint32_t index : unreferenced)
+			freeNode(index);
+	}
+	clearCache();
+}
+
+void Bdd::swapLevels(int level) {
+	// a node of the upper variable x depending on the lower variable y becomes a node of y with
+	// children of x in place, the other nodes of x just move down a level
+	const int x = variables[level];
+	const int y = variables[level + 1];
+	std::vector<uint32_t> upperNodes;
+	for (auto& item : uniqueTables[x])
+		upperNodes.push_back(item.second);
+	for (uint32_t index : upperNodes) {
+		const Edge f0 = nodes[index].low;
+		const Edge f1 = nodes[index].high;
+		if (getEdgeLevel(f0) != level + 1 && getEdgeLevel(f1) != level + 1)
+			continue;
+		Edge f00, f01, f10, f11;
+		getCofactors(f0, level + 1, f00, f01);
+		getCofactors(f1, level + 1, f10, f11);
+		const Edge low = makeNode(x, f00, f10);
+		ref(low);
+		const Edge high = makeNode(x, f01, f11);
+		ref(high);
+		assert(!isComplemented(high));
+		uniqueTables[x].erase(getKey(f0, f1));
+		nodes[index] = { y, low, high };
+		uniqueTables[y].emplace(getKey(low, high), index);
+		for (Edge child : { f0, f1 }) {
+			const uint32_t childIndex = getIndex(child);
+			if (childIndex != 0 && --refCounts[childIndex] == 0)
+				freeNode(childIndex);
+		}
+	}
+	std::swap(variables[level], variables[level + 1]);
+	levels[x] = level + 1;
+	levels[y] = level;
+}
+
+void Bdd::siftVariable(int variable) {
+	// down to the bottom, up to the top and back to the level with the fewest nodes,
+	// a direction is given up once the diagram grows too much; the budget is checked after
+	// every swap, any order is valid when it is exceeded
+	size_t bestCount = nodeCount;
+	int bestLevel = levels[variable];
+	for (int direction = 1; direction >= -1; direction -= 2) {
+		while (nodeCount * 100 <= bestCount * MAX_SIFTING_GROWTH_PERCENT) {
+			const int level = levels[variable];
+			if (direction == 1 ? level + 1 == getVariableCount() : level == 0)
+				break;
+			swapLevels(direction == 1 ? level : level - 1);
+			checkBudget();
+			if (interrupted)
+				return;
+			if (nodeCount < bestCount) {
+				bestCount = nodeCount;
+				bestLevel = levels[variable];
+			}
+		}
+	}
+	while (levels[variable] < bestLevel)
+		swapLevels(levels[variable]);
+	while (levels[variable] > bestLevel)
+		swapLevels(levels[variable] - 1);
+}
+
+void Bdd::reorder() {
+	collectGarbage();
+	std::vector<int> order(getVariableCount());
+	for (int i = 0; i < getVariableCount(); i++)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [this](int lhs, int rhs) {
+		return uniqueTables[lhs].size() > uniqueTables[rhs].size();
+	});
+	for (int variable : order)
+		if (!interrupted)
+			siftVariable(variable);
+	clearCache(); // freed nodes are reused
+}
+
+BigInteger Bdd::countModels(Edge f) const {
+	std::unordered_map<uint32_t, BigInteger> counts;
+	return countModels(f, 0, counts);
+}
+
+BigInteger Bdd::countModels(Edge f, int level, std::unordered_map<uint32_t, BigInteger>& counts) const {
+	// counts[node] are the models of its regular edge over the variables from its level down
+	const int nodeLevel = getEdgeLevel(f);
+	const uint32_t index = getIndex(f);
+	auto it = counts.find(index);
+	if (it == counts.end()) {
+		BigInteger count(1);
+		if (index != 0)
+			count = countModels(nodes[index].low, nodeLevel + 1, counts) +
+				countModels(nodes[index].high, nodeLevel + 1, counts);
+		it = counts.emplace(index, count).first;
+	}
+	BigInteger result = it->second;
+	if (isComplemented(f))
+		result = BigInteger::powerOfTwo(getVariableCount() - nodeLevel) - result;
+	return result << (nodeLevel - level);
+}
+
+size_t Bdd::getNodeCount() const {
+	return nodeCount;
+}
+
+size_t Bdd::getNodeCount(Edge f) const {
+	std::vector<bool> visited(nodes.size());
+	std::vector<uint32_t> stack{ getIndex(f) };
+	size_t count = 0;
+	while (!stack.empty()) {
+		const uint32_t index = stack.back();
+		stack.pop_back();
+		if (visited[index])
+			continue;
+		visited[index] = true;
+		count++;
+		if (index != 0) {
+			stack.push_back(getIndex(nodes[index].low));
+			stack.push_back(getIndex(nodes[index].high));
+		}
+	}
+	return count;
+}
+
+Proposition::Validity Bdd::classifyProp(const PropositionSP& proposition) {
+	Budget budget;
+	return classifyProp(proposition, budget);
+}
+
+Proposition::Validity Bdd::classifyProp(const PropositionSP& proposition, Budget& budget) {
+	Bdd bdd;
+	bdd.setBudget(&budget);
+	const Edge f = bdd.fromProposition(proposition);
+	if (bdd.isInterrupted())
+		return Proposition::UNDECIDED;
+	return f == ONE ? Proposition::VALID : (f == ZERO ? Proposition::CONTRADICTION : Proposition::CONTINGENT);
+}
+
+bool Bdd::arePropsEquivalent(const PropositionSP& lhs, const PropositionSP& rhs) {
+	Bdd bdd;
+	const Edge f = bdd.fromProposition(lhs);
+	return bdd.fromProposition(rhs) == f;
+}
+
+BigInteger Bdd::countPropModels(const PropositionSP& proposition) {
+	Bdd bdd;
+	return bdd.countModels(bdd.fromProposition(proposition));
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Proposition.hpp"
+#include "BigInteger.hpp"
+#include "Budget.hpp"
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+/* Reduced ordered binary decision diagrams with complement edges. An edge is a node
+ * index shifted left by one with the complement flag in the lowest bit. The high edge
+ * of a node is never complemented, so every function has exactly one edge and
+ * equivalence is an edge comparison. Nodes are hash-consed in a unique table per
+ * variable, ite results are kept in a lossy computed cache.
+ *
+ * Nodes are reference counted. The edges returned by the operations are not referenced,
+ * they stay valid until the next garbage collection, which happens only in
+ * collectGarbage(), reorder() and fromProposition(); ref() keeps an edge valid across
+ * them. Reordering by sifting swaps adjacent levels in place, so the referenced edges
+ * keep their functions.
+ */
+class Bdd {
+public:
+	typedef uint32_t Edge;
+	static const Edge ONE = 0;
+	static const Edge ZERO = 1;
+
+	Bdd();
+	~Bdd() = default;
+	Bdd(const Bdd&) = delete;
+	Bdd& operator=(const Bdd&) = delete;
+
+	void setBudget(Budget* budget); // a created node is a step
+	bool isInterrupted() const; // true once the budget was exceeded, all results since are meaningless
+	// Sifting in fromProposition() whenever the node count doubles, garbage collection only if off
+	void setAutoReorder(bool autoReorder); // on by default
+
+	int addVariable(); // at the lowest level, returns its index
+	int getVariableCount() const;
+	int getLevel(int variable) const;
+
+	Edge getVariable(int variable);
+	static Edge negate(Edge f);
+	Edge ite(Edge f, Edge g, Edge h); // if f then g else h
+	Edge apply(Edge f, int op, Edge g); // op is a BinaryOperator::Op
+	// Referenced; the proposition variables get BDD variables on their first occurrence, in increasing id order
+	Edge fromProposition(const PropositionSP& proposition);
+
+	void ref(Edge f);
+	void deref(Edge f);
+	void collectGarbage(); // frees the nodes without references
+	void reorder(); // sifting of each variable, the most frequent first; stops once the budget is exceeded
+
+	BigInteger countModels(Edge f) const; // over all variables
+	size_t getNodeCount() const; // including the terminal and nodes not collected yet
+	size_t getNodeCount(Edge f) const; // reachable from f, including the terminal
+
+	static Proposition::Validity classifyProp(const PropositionSP& proposition);
+	static Proposition::Validity classifyProp(const PropositionSP& proposition, Budget& budget);
+	static bool arePropsEquivalent(const PropositionSP& lhs, const PropositionSP& rhs);
+	static BigInteger countPropModels(const PropositionSP& proposition); // models over the proposition variables
+
+private:
+	static const uint32_t BUDGET_CHECK_INTERVAL = 4096; // created nodes
+	static const size_t NODE_MEMORY = 64; // rough estimate: the node, its unique table entry and its count
+	static const size_t CACHE_SIZE = 1 << 18; // entries, a power of two
+	static const size_t MIN_REORDER_NODE_COUNT = 4096;
+	static const int MAX_SIFTING_GROWTH_PERCENT = 120; // a variable is not moved further once exceeded
+
+	struct Node {
+		int variable; // -1 for the terminal
+		Edge low;
+		Edge high; // never complemented
+	};
+
+	struct CacheEntry {
+		Edge f;
+		Edge g;
+		Edge h;
+		Edge result;
+	};
+
+	std::vector<Node> nodes; // the terminal ONE first
+	std::vector<uint32_t> refCounts;
+	std::vector<uint32_t> freeNodes;
+	size_t nodeCount;
+	uint64_t createdNodeCount;
+	uint64_t budgetCheckNodeCount; // the next budget check
+	std::vector<std::unordered_map<uint64_t, uint32_t>> uniqueTables; // per variable, (low, high) -> node
+	std::vector<int> levels; // variable -> level
+	std::vector<int> variables; // level -> variable
+	std::vector<CacheEntry> cache;
+	std::unordered_map<int, int> propositionVariables; // proposition variable id -> variable
+	Budget* budget;
+	bool interrupted;
+	bool autoReorder;
+	size_t reorderNodeCount; // the next reordering or garbage collection in fromProposition()
+
+	static uint32_t getIndex(Edge f);
+	static bool isComplemented(Edge f);
+	static uint64_t getKey(Edge low, Edge high);
+	int getEdgeLevel(Edge f) const;
+	void getCofactors(Edge f, int level, Edge& low, Edge& high) const;
+	Edge getNode(int variable, Edge low, Edge high); // checks the budget
+	Edge makeNode(int variable, Edge low, Edge high);
+	void checkBudget(); // charges the nodes created since the last check
+	void freeNode(uint32_t index); // and the children left without references
+	void clearCache();
+	Edge build(const PropositionSP& proposition);
+	void swapLevels(int level); // with the level below
+	void siftVariable(int variable);
+	BigInteger countModels(Edge f, int level, std::unordered_map<uint32_t, BigInteger>& counts) const;
+};
@@ -0,0 +1,154 @@
+#include "BigInteger.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+BigInteger::BigInteger(uint64_t value) {
+	while (value) {
+		words.push_back(static_cast<uint32_t>(value));
+		value >>= 32;
+	}
+}
+
+BigInteger BigInteger::powerOfTwo(unsigned exponent) {
+	return BigInteger(1) << exponent;
+}
+
+bool BigInteger::isZero() const {
+	return words.empty();
+}
+
+std::string BigInteger::toString() const {
+	if (isZero())
+		return "0";
+	// repeated division by 10^9
+	const uint32_t BASE = 1000000000;
+	std::vector<uint32_t> quotient = words;
+	std::vector<uint32_t> chunks;
+	while (!quotient.empty()) {
+		uint64_t remainder = 0;
+		for (size_t i = quotient.size(); i-- > 0;) {
+			uint64_t current = (remainder << 32) | quotient[i];
+			quotient[i] = static_cast<uint32_t>(current / BASE);
+			remainder = current % BASE;
+		}
+		chunks.push_back(static_cast<uint32_t>(remainder));
+		while (!quotient.empty() && quotient.back() == 0)
+			quotient.pop_back();
+	}
+	std::string result = std::to_string(chunks.back());
+	for (size_t i = chunks.size() - 1; i-- > 0;) {
+		std::string chunk = std::to_string(chunks[i]);
+		result += std::string(9 - chunk.length(), '0') + chunk;
+	}
+	return result;
+}
+
+BigInteger& BigInteger::operator+=(const BigInteger& rhs) {
+	if (words.size() < rhs.words.size())
+		words.resize(rhs.words.size());
+	uint64_t carry = 0;
+	for (size_t i = 0; i < words.size(); i++) {
+		uint64_t sum = carry + words[i] + (i < rhs.words.size() ? rhs.words[i] : 0);
+		words[i] = static_cast<uint32_t>(sum);
+		carry = sum >> 32;
+		if (carry == 0 && i >= rhs.words.size())
+			break;
+	}
+	if (carry)
+		words.push_back(static_cast<uint32_t>(carry));
+	return *this;
+}
+
+BigInteger& BigInteger::operator-=(const BigInteger& rhs) {
+	assert(!(*this < rhs));
+	int64_t borrow = 0;
+	for (size_t i = 0; i < words.size(); i++) {
+		int64_t difference = static_cast<int64_t>(words[i]) - borrow -
+			(i < rhs.words.size() ? rhs.words[i] : 0);
+		borrow = difference < 0;
+		words[i] = static_cast<uint32_t>(difference + (borrow << 32));
+		if (borrow == 0 && i >= rhs.words.size())
+			break;
+	}
+	trim();
+	return *this;
+}
+
+BigInteger& BigInteger::operator*=(const BigInteger& rhs) {
+	*this = *this * rhs;
+	return *this;
+}
+
+BigInteger& BigInteger::operator<<=(unsigned shift) {
+	if (isZero())
+		return *this;
+	const unsigned wordShift = shift / 32;
+	const unsigned bitShift = shift % 32;
+	if (bitShift) {
+		uint32_t carry = 0;
+		for (auto& word : words) {
+			uint32_t newCarry = word >> (32 - bitShift);
+			word = (word << bitShift) | carry;
+			carry = newCarry;
+		}
+		if (carry)
+			words.push_back(carry);
+	}
+	words.insert(words.begin(), wordShift, 0);
+	return *this;
+}
+
+BigInteger BigInteger::operator+(const BigInteger& rhs) const {
+	BigInteger result = *this;
+	return result += rhs;
+}
+
+BigInteger BigInteger::operator-(const BigInteger& rhs) const {
+	BigInteger result = *this;
+	return result -= rhs;
+}
+
+BigInteger BigInteger::operator*(const BigInteger& rhs) const {
+	BigInteger result;
+	if (isZero() || rhs.isZero())
+		return result;
+	result.words.resize(words.size() + rhs.words.size());
+	for (size_t i = 0; i < words.size(); i++) {
+		uint64_t carry = 0;
+		for (size_t j = 0; j < rhs.words.size(); j++) {
+			uint64_t current = static_cast<uint64_t>(words[i]) * rhs.words[j] +
+				result.words[i + j] + carry;
+			result.words[i + j] = static_cast<uint32_t>(current);
+			carry = current >> 32;
+		}
+		result.words[i + rhs.words.size()] = static_cast<uint32_t>(carry);
+	}
+	result.trim();
+	return result;
+}
+
+BigInteger BigInteger::operator<<(unsigned shift) const {
+	BigInteger result = *this;
+	return result <<= shift;
+}
+
+bool BigInteger::operator==(const BigInteger& rhs) const {
+	return words == rhs.words;
+}
+
+bool BigInteger::operator!=(const BigInteger& rhs) const {
+	return !operator==(rhs);
+}
+
+bool BigInteger::operator<(const BigInteger& rhs) const {
+	if (words.size() != rhs.words.size())
+		return words.size() < rhs.words.size();
+	return std::lexicographical_compare(words.rbegin(), words.rend(),
+		                                rhs.words.rbegin(), rhs.words.rend());
+}
+
+void BigInteger::trim() {
+	while (!words.empty() && words.back() == 0)
+		words.pop_back();
+}
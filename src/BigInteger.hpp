@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Non-negative arbitrary-precision integer
+class BigInteger {
+public:
+	BigInteger(uint64_t value = 0);
+
+	static BigInteger powerOfTwo(unsigned exponent);
+
+	bool isZero() const;
+	std::string toString() const;
+
+	BigInteger& operator+=(const BigInteger& rhs);
+	BigInteger& operator-=(const BigInteger& rhs); // rhs must not be greater than *this
+	BigInteger& operator*=(const BigInteger& rhs);
+	BigInteger& operator<<=(unsigned shift);
+
+	BigInteger operator+(const BigInteger& rhs) const;
+	BigInteger operator-(const BigInteger& rhs) const;
+	BigInteger operator*(const BigInteger& rhs) const;
+	BigInteger operator<<(unsigned shift) const;
+
+	bool operator==(const BigInteger& rhs) const;
+	bool operator!=(const BigInteger& rhs) const;
+	bool operator<(const BigInteger& rhs) const;
+
+private:
+	std::vector<uint32_t> words; // little-endian, no leading zero words
+
+	void trim();
+};
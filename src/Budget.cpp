@@ -0,0 +1,65 @@
+#include "Budget.hpp"
+
+#include <limits>
+
+Budget::Budget(Budget* parent) : parent(parent), reason(NONE), stepCount(0),
+                                 stepLimit(std::numeric_limits<uint64_t>::max()),
+                                 memoryLimit(std::numeric_limits<size_t>::max()),
+                                 timeLimited(false) {}
+
+void Budget::setTimeLimit(std::chrono::milliseconds timeLimit) {
+	timeLimited = true;
+	deadline = std::chrono::steady_clock::now() + timeLimit;
+}
+
+void Budget::setStepLimit(uint64_t stepLimit) {
+	this->stepLimit = stepLimit;
+}
+
+void Budget::setMemoryLimit(size_t memoryLimit) {
+	this->memoryLimit = memoryLimit;
+}
+
+void Budget::stop() {
+	exceed(STOPPED);
+}
+
+bool Budget::isExceeded(uint64_t steps, size_t memoryUsage) {
+	if (reason.load(std::memory_order_relaxed) != NONE)
+		return true;
+	uint64_t count = stepCount.fetch_add(steps, std::memory_order_relaxed) + steps;
+	if (count > stepLimit)
+		return exceed(STEPS);
+	if (memoryUsage > memoryLimit)
+		return exceed(MEMORY);
+	if (timeLimited && (steps == 0 || count / TIME_CHECK_INTERVAL != (count - steps) / TIME_CHECK_INTERVAL))
+		if (std::chrono::steady_clock::now() >= deadline)
+			return exceed(TIME);
+	if (parent && parent->isExceeded(steps, memoryUsage))
+		return exceed(parent->getReason());
+	return false;
+}
+
+bool Budget::isStopped() const {
+	if (reason.load(std::memory_order_relaxed) != NONE)
+		return true;
+	return parent && parent->isStopped();
+}
+
+Budget::Reason Budget::getReason() const {
+	return static_cast<Reason>(reason.load());
+}
+
+uint64_t Budget::getStepCount() const {
+	return stepCount.load();
+}
+
+Budget::Answer Budget::toAnswer(bool value) {
+	return value ? YES : NO;
+}
+
+bool Budget::exceed(Reason reason) {
+	int expected = NONE;
+	this->reason.compare_exchange_strong(expected, reason);
+	return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/* Resource budget polled by the engines: wall time, steps (DPLL nodes, flips,
+ * processed clauses, deduction steps, ...), an estimate of the memory held by
+ * the engine and a stop flag which may be raised from any thread. Once a limit
+ * is reached the budget stays exceeded and the engine gives up with an
+ * unknown answer. A child budget charges its steps to its parent as well and
+ * is exceeded whenever the parent is.
+ */
+class Budget {
+public:
+	enum Answer { NO, YES, UNKNOWN };
+	enum Reason { NONE, STOPPED, TIME, STEPS, MEMORY };
+
+	Budget(Budget* parent = nullptr);
+	~Budget() = default;
+	Budget(const Budget&) = delete;
+	Budget& operator=(const Budget&) = delete;
+
+	void setTimeLimit(std::chrono::milliseconds timeLimit); // counted from now
+	void setStepLimit(uint64_t stepLimit);
+	void setMemoryLimit(size_t memoryLimit); // bytes
+	void stop();
+
+	bool isExceeded(uint64_t steps = 1, size_t memoryUsage = 0); // counts the steps
+	bool isStopped() const; // true once any limit was reached, no counting
+	Reason getReason() const;
+	uint64_t getStepCount() const;
+
+	static Answer toAnswer(bool value);
+
+private:
+	static const uint64_t TIME_CHECK_INTERVAL = 32; // steps between clock reads
+
+	Budget* parent;
+	std::atomic<int> reason;
+	std::atomic<uint64_t> stepCount;
+	uint64_t stepLimit;
+	size_t memoryLimit;
+	bool timeLimited;
+	std::chrono::steady_clock::time_point deadline;
+
+	bool exceed(Reason reason);
+};
@@ -1,26 +1,68 @@
 #include "CnfSat.hpp"
 
 #include "UnaryOperator.hpp"
+#include "ThreadPool.hpp"
 
 #include <cassert>
 #include <random>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+#include <memory>
 
-DpllCnfSat::DpllCnfSat(const Cnf& cnf) : clauses(cnf) {
-	squeezeVariableIds(clauses);
-	clauses.shrink_to_fit();
-	int variableCount = 0;
-	for (auto& clause : clauses)
-		for (auto& literal : clause)
-			variableCount = std::max(literal.varId + 1, variableCount);
-	if (variableCount > 0) {
-		variableAssigned.resize(variableCount);
-		variableValues.resize(variableCount);
-		negativeLiteralCount.resize(variableCount);
-		positiveLiteralCount.resize(variableCount);
+namespace {
+	inline int literalIndex(const Literal& literal) {
+		return literal.varId * 2 + (literal.neg ? 1 : 0);
 	}
 }
 
+DpllCnfSat::DpllCnfSat() : squeezedClauseCount(0), branching(FIRST_UNASSIGNED), firstValue(false),
+                           budget(nullptr), unchargedNodeCount(0), interrupted(false), proofWriter(nullptr) {}
+
+DpllCnfSat::DpllCnfSat(const Cnf& cnf) : DpllCnfSat() {
+	clauses = cnf;
+	squeezeAddedClauses();
+	clauses.shrink_to_fit();
+}
+
+void DpllCnfSat::setBranching(Branching branching, bool firstValue) {
+	this->branching = branching;
+	this->firstValue = firstValue;
+}
+
+void DpllCnfSat::setBudget(Budget* budget) {
+	this->budget = budget;
+}
+
+void DpllCnfSat::setProofWriter(DratWriter* proofWriter) {
+	this->proofWriter = proofWriter;
+}
+
 bool DpllCnfSat::isSatisfiable() {
+	squeezeAddedClauses();
+	interrupted = false;
+	proofLemma.clear();
+	if (clauses.empty())
+		return true;
+	for (auto& clause : clauses) {
+		if (clause.empty()) {
+			writeRefutation({});
+			return false;
+		}
+	}
+	for (int i = 0; i < variableAssigned.size(); i++)
+		variableAssigned[i] = false;
+	bool result = dpll(0, firstValue) || dpll(0, !firstValue);
+	if (!result)
+		writeRefutation({ Literal(0, firstValue), Literal(0, !firstValue) });
+	return result;
+}
+
+bool DpllCnfSat::isSatisfiable(const std::vector<Literal>& assumptions) {
+	squeezeAddedClauses();
+	interrupted = false;
 	if (clauses.empty())
 		return true;
 	for (auto& clause : clauses)
@@ -28,12 +70,44 @@ bool DpllCnfSat::isSatisfiable() {
 			return false;
 	for (int i = 0; i < variableAssigned.size(); i++)
 		variableAssigned[i] = false;
-	return dpll(0, false) || dpll(0, true);
+	VariableId entryId = -1;
+	for (auto& assumption : assumptions) {
+		VariableId id = assumption.varId;
+		if (id < 0 || id >= variableAssigned.size())
+			continue; // variable does not occur in the clauses
+		if (variableAssigned[id] && variableValues[id] == assumption.neg)
+			return false; // contradictory assumptions
+		variableAssigned[id] = true;
+		variableValues[id] = !assumption.neg;
+		entryId = id;
+	}
+	if (entryId == -1)
+		return isSatisfiable();
+	DratWriter* writer = proofWriter;
+	proofWriter = nullptr; // a refutation under assumptions is not a proof
+	bool result = dpll(entryId, variableValues[entryId]);
+	proofWriter = writer;
+	return result;
+}
+
+bool DpllCnfSat::isInterrupted() const {
+	return interrupted;
 }
 
 bool DpllCnfSat::dpll(VariableId id, bool value) {
+	if (interrupted)
+		return false; // the sibling branches are not searched after a stop
+	if (budget && ++unchargedNodeCount == BUDGET_CHECK_INTERVAL) {
+		unchargedNodeCount = 0;
+		if (budget->isExceeded(BUDGET_CHECK_INTERVAL)) {
+			interrupted = true;
+			return false;
+		}
+	}
 	variableAssigned[id] = true;
 	variableValues[id] = value;
+	if (proofWriter)
+		proofLemma.push_back(Literal(id, value));
 
 	assert(negativeLiteralCount.size() == positiveLiteralCount.size());
 	for (int i = 0; i < positiveLiteralCount.size(); i++) {
@@ -91,13 +165,20 @@ bool DpllCnfSat::dpll(VariableId id, bool value) {
 			trueSentence = false;
 	}
 	if (falseSentence || trueSentence) {
+		if (falseSentence) {
+			stats.conflicts++;
+			writeRefutation({});
+		}
 		variableAssigned[id] = false;
+		if (proofWriter)
+			proofLemma.pop_back();
 		return trueSentence;
 	}
 
+	// a pure literal assignment does not yield a RUP lemma
 	VariableId pureLiteralVarId = -1;
 	bool pureLiteralNeg;
-	for (int i = 0; i < positiveLiteralCount.size(); i++) {
+	for (int i = 0; i < positiveLiteralCount.size() && !proofWriter; i++) {
 		int nlc = negativeLiteralCount[i];
 		int plc = positiveLiteralCount[i];
 		if ((nlc == 0 && plc > 0) || (nlc > 0 && plc == 0)) {
@@ -109,28 +190,118 @@ bool DpllCnfSat::dpll(VariableId id, bool value) {
 	if (pureLiteralVarId != -1) {
 		bool result = dpll(pureLiteralVarId, !pureLiteralNeg);
 		variableAssigned[id] = false;
+		if (proofWriter)
+			proofLemma.pop_back();
 		return result;
 	}
 
 	if (unitClauseVarId != -1) {
+		stats.propagations++;
 		bool result = dpll(unitClauseVarId, !unitClauseLiteralNeg);
+		if (!result)
+			writeRefutation({ Literal(unitClauseVarId, !unitClauseLiteralNeg) });
 		variableAssigned[id] = false;
+		if (proofWriter)
+			proofLemma.pop_back();
 		return result;
 	}
 
 	VariableId unassignVarId = 0;
-	while (unassignVarId < variableAssigned.size() && variableAssigned[unassignVarId])
-		unassignVarId++;
-	assert(unassignVarId < variableAssigned.size());
-	bool result = dpll(unassignVarId, false) || dpll(unassignVarId, true);
+	if (branching == MOST_OCCURRENCES) {
+		int maxOccurrences = 0;
+		for (int i = 0; i < positiveLiteralCount.size(); i++) {
+			int occurrences = negativeLiteralCount[i] + positiveLiteralCount[i];
+			if (occurrences > maxOccurrences) {
+				maxOccurrences = occurrences;
+				unassignVarId = i;
+			}
+		}
+	}
+	else {
+		while (unassignVarId < variableAssigned.size() && variableAssigned[unassignVarId])
+			unassignVarId++;
+	}
+	assert(unassignVarId < variableAssigned.size() && !variableAssigned[unassignVarId]);
+	stats.decisions++;
+	bool result = dpll(unassignVarId, firstValue) || dpll(unassignVarId, !firstValue);
+	if (!result)
+		writeRefutation({ Literal(unassignVarId, firstValue), Literal(unassignVarId, !firstValue) });
 	variableAssigned[id] = false;
+	if (proofWriter)
+		proofLemma.pop_back();
 	return result;
 }
 
+void DpllCnfSat::writeRefutation(const std::vector<Literal>& childLiterals) {
+	// The negated path of a refuted node is RUP: its literals together with the lemmas
+	// of the refuted children (or a false clause) propagate to a conflict. The lemmas
+	// of the children are not needed any more.
+	if (!proofWriter || interrupted)
+		return;
+	proofWriter->addClause(proofLemma);
+	for (auto& literal : childLiterals) {
+		proofLemma.push_back(literal);
+		proofWriter->deleteClause(proofLemma);
+		proofLemma.pop_back();
+	}
+	if (proofLemma.empty())
+		proofWriter->flush();
+}
+
 std::vector<bool> DpllCnfSat::getModel() const {
 	return variableValues;
 }
 
+void DpllCnfSat::addClause(const Clause& clause) {
+	clauses.push_back(clause);
+}
+
+void DpllCnfSat::addCnf(Cnf&& cnf) {
+	if (clauses.empty())
+		clauses = std::move(cnf);
+	else
+		clauses.insert(clauses.end(), std::make_move_iterator(cnf.begin()), std::make_move_iterator(cnf.end()));
+	cnf.clear();
+}
+
+Budget::Answer DpllCnfSat::solve(const std::vector<Literal>& assumptions) {
+	squeezeAddedClauses();
+	std::vector<Literal> squeezedAssumptions;
+	if (!squeezeAssumptions(assumptions, originalIds, squeezedAssumptions))
+		return Budget::NO;
+	bool result = isSatisfiable(squeezedAssumptions);
+	if (interrupted)
+		return Budget::UNKNOWN;
+	return Budget::toAnswer(result);
+}
+
+bool DpllCnfSat::getValue(VariableId id) const {
+	auto it = std::lower_bound(originalIds.begin(), originalIds.end(), id);
+	if (it == originalIds.end() || *it != id)
+		return getFreeValue(id);
+	return variableValues[it - originalIds.begin()];
+}
+
+SatSolver::Stats DpllCnfSat::getStats() const {
+	return stats;
+}
+
+std::string DpllCnfSat::getName() const {
+	return "DPLL";
+}
+
+void DpllCnfSat::squeezeAddedClauses() {
+	if (squeezedClauseCount == clauses.size())
+		return;
+	squeezeVariableIds(clauses, originalIds, squeezedClauseCount);
+	squeezedClauseCount = clauses.size();
+	const size_t variableCount = originalIds.size();
+	variableAssigned.resize(variableCount);
+	variableValues.resize(variableCount);
+	negativeLiteralCount.resize(variableCount);
+	positiveLiteralCount.resize(variableCount);
+}
+
 bool DpllCnfSat::isPropValid(const PropositionSP& proposition) {
 	auto notProposition = std::make_shared<UnaryOperator>(proposition, UnaryOperator::NOT);
 	return isPropContradiction(notProposition);
@@ -143,90 +314,568 @@ bool DpllCnfSat::isPropContradiction(const PropositionSP& proposition) {
 	return !dpll.isSatisfiable();
 }
 
-WalkSat::WalkSat(const Cnf& cnf) : clauses(cnf) {
-	squeezeVariableIds(clauses);
-	clauses.shrink_to_fit();
-	int variableCount = 0;
-	for (auto& clause : clauses)
-		for (auto& literal : clause)
-			variableCount = std::max(literal.varId + 1, variableCount);
-	if (variableCount > 0) {
-		model.resize(variableCount);
-		std::random_device rd;
-		std::mt19937 gen(rd());
-		std::uniform_int_distribution<> dist(0, 1);
-		for (int i = 0; i < model.size(); i++)
-			model[i] = dist(gen);
+Budget::Answer DpllCnfSat::isPropValid(const PropositionSP& proposition, Budget& budget) {
+	auto notProposition = std::make_shared<UnaryOperator>(proposition, UnaryOperator::NOT);
+	return isPropContradiction(notProposition, budget);
+}
+
+Budget::Answer DpllCnfSat::isPropContradiction(const PropositionSP& proposition, Budget& budget) {
+	Cnf clauses;
+	propositionToCnf(clauses, proposition);
+	DpllCnfSat dpll(clauses);
+	dpll.setBudget(&budget);
+	bool result = !dpll.isSatisfiable();
+	if (dpll.isInterrupted())
+		return Budget::UNKNOWN;
+	return Budget::toAnswer(result);
+}
+
+Proposition::Validity DpllCnfSat::classifyProp(const PropositionSP& proposition) {
+	Budget budget;
+	return classifyProp(proposition, budget);
+}
+
+Proposition::Validity DpllCnfSat::classifyProp(const PropositionSP& proposition, Budget& budget) {
+	Cnf clauses;
+	const Literal output = propositionToTseitinCnf(clauses, proposition);
+	DpllCnfSat dpll(clauses);
+	dpll.setBudget(&budget);
+	const Budget::Answer satisfiable = dpll.solve({ output });
+	if (satisfiable != Budget::YES)
+		return satisfiable == Budget::NO ? Proposition::CONTRADICTION : Proposition::UNDECIDED;
+	const Budget::Answer falsifiable = dpll.solve({ Literal(output.varId, !output.neg) });
+	if (falsifiable == Budget::UNKNOWN)
+		return Proposition::UNDECIDED;
+	return falsifiable == Budget::NO ? Proposition::VALID : Proposition::CONTINGENT;
+}
+
+struct WalkSat::Walker {
+	std::mt19937 gen;
+	std::vector<bool> model;
+	std::vector<int> trueLiteralCounts; // clause index -> number of true literals
+	std::vector<int> unsatClauses;
+	std::vector<int> unsatPositions; // clause index -> position in unsatClauses or -1
+	std::vector<int> clauseWeights; // PAWS only, 1 otherwise
+	std::vector<uint64_t> flipSteps; // variable -> step of its last flip
+	uint64_t step;
+	uint64_t weightIncreaseCount;
+	uint64_t flipCount;
+	bool interrupted;
+
+	Walker() : step(0), weightIncreaseCount(0), flipCount(0), interrupted(false) {}
+
+	void addUnsatClause(int clauseIndex) {
+		unsatPositions[clauseIndex] = static_cast<int>(unsatClauses.size());
+		unsatClauses.push_back(clauseIndex);
+	}
+
+	void removeUnsatClause(int clauseIndex) {
+		// the last clause takes the place of the removed one
+		int position = unsatPositions[clauseIndex];
+		int lastClauseIndex = unsatClauses.back();
+		unsatClauses[position] = lastClauseIndex;
+		unsatPositions[lastClauseIndex] = position;
+		unsatClauses.pop_back();
+		unsatPositions[clauseIndex] = -1;
 	}
+};
+
+WalkSat::WalkSat() : squeezedClauseCount(0), budget(nullptr), heuristic(WALKSAT), seeded(false), seed(0),
+                     walkerCount(1), restartFlipNumber(0), threadCount(0) {}
+
+WalkSat::WalkSat(const Cnf& cnf) : WalkSat() {
+	clauses = cnf;
+	squeezeAddedClauses();
+	clauses.shrink_to_fit();
+}
+
+void WalkSat::setHeuristic(Heuristic heuristic) {
+	this->heuristic = heuristic;
+}
+
+void WalkSat::setSeed(uint64_t seed) {
+	seeded = true;
+	this->seed = seed;
+}
+
+void WalkSat::setWalkers(unsigned walkerCount, uint64_t restartFlipNumber, unsigned threadCount) {
+	this->walkerCount = std::max(walkerCount, 1u);
+	this->restartFlipNumber = restartFlipNumber;
+	this->threadCount = threadCount;
 }
 
 bool WalkSat::isSatisfiable(uint64_t maxFlipNumber, float randWalkP) {
+	// walkers without restarts report back after this many flips
+	const uint64_t ROUND_FLIP_NUMBER = 100000;
+	squeezeAddedClauses();
 	if (clauses.empty())
 		return true;
 	for (auto& clause : clauses)
 		if (clause.empty())
 			return false;
 
+	initOccurrences();
+	std::vector<Walker> walkers(walkerCount);
 	std::random_device rd;
-	std::mt19937 gen(rd());
-	const int maxValue = static_cast<int>(clauses.size() + model.size());
-	std::uniform_int_distribution<> iDist(0, maxValue);
-	std::uniform_real_distribution<float> fDist(0.f, 1.f);
+	for (unsigned i = 0; i < walkerCount; i++) {
+		if (seeded) {
+			std::seed_seq seedSequence{ static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), i };
+			walkers[i].gen.seed(seedSequence);
+		}
+		else
+			walkers[i].gen.seed(rd());
+		initWalker(walkers[i]);
+	}
+	std::unique_ptr<ThreadPool> pool;
+	if (walkerCount > 1)
+		pool.reset(new ThreadPool(threadCount > 0 ? threadCount : walkerCount));
 
-	for (uint64_t i = 0; i < maxFlipNumber; i++) {
-		falseClauses.clear();
-		bool trueSentence = true;
-		for (auto& clause : clauses) {
-			bool trueClause = false;
-			for (auto& literal : clause) {
-				if (model[literal.varId] != literal.neg) {
-					trueClause = true;
-					break;
-				}
-			}
-			if (!trueClause) {
-				trueSentence = false;
-				falseClauses.push_back(&clause);
-				break;
+	const uint64_t roundFlipNumber = restartFlipNumber > 0 ? restartFlipNumber : ROUND_FLIP_NUMBER;
+	int winner = -1;
+	bool interrupted = false;
+	for (uint64_t flipNumber = 0; flipNumber < maxFlipNumber && winner == -1 && !interrupted;) {
+		const uint64_t roundFlips = std::min(roundFlipNumber, maxFlipNumber - flipNumber);
+		std::atomic<int> winnerIndex(static_cast<int>(walkerCount));
+		if (pool) {
+			for (unsigned i = 0; i < walkerCount; i++) {
+				Walker& walker = walkers[i];
+				pool->submit([this, &walker, roundFlips, randWalkP, i, &winnerIndex] {
+					walk(walker, roundFlips, randWalkP, i, winnerIndex);
+				});
 			}
+			pool->wait();
+		}
+		else
+			walk(walkers[0], roundFlips, randWalkP, 0, winnerIndex);
+		flipNumber += roundFlips;
+		for (unsigned i = 0; i < walkerCount && winner == -1; i++)
+			if (walkers[i].unsatClauses.empty())
+				winner = i;
+		for (auto& walker : walkers)
+			interrupted = interrupted || walker.interrupted;
+		if (winner == -1 && !interrupted && restartFlipNumber > 0 && flipNumber < maxFlipNumber)
+			for (auto& walker : walkers)
+				initWalker(walker);
+	}
+
+	for (auto& walker : walkers)
+		stats.flips += walker.flipCount;
+	model = walkers[winner == -1 ? 0 : winner].model;
+	return winner != -1;
+}
+
+std::vector<bool> WalkSat::getModel() const {
+	return model;
+}
+
+void WalkSat::setBudget(Budget* budget) {
+	this->budget = budget;
+}
+
+void WalkSat::addClause(const Clause& clause) {
+	clauses.push_back(clause);
+}
+
+void WalkSat::addCnf(Cnf&& cnf) {
+	if (clauses.empty())
+		clauses = std::move(cnf);
+	else
+		clauses.insert(clauses.end(), std::make_move_iterator(cnf.begin()), std::make_move_iterator(cnf.end()));
+	cnf.clear();
+}
+
+Budget::Answer WalkSat::solve(const std::vector<Literal>& assumptions) {
+	const uint64_t MAX_FLIP_NUMBER = 1000;
+	squeezeAddedClauses();
+	std::vector<Literal> squeezedAssumptions;
+	if (!squeezeAssumptions(assumptions, originalIds, squeezedAssumptions))
+		return Budget::NO;
+	// assumptions are temporary unit clauses
+	const size_t clauseCount = clauses.size();
+	for (auto& assumption : squeezedAssumptions)
+		clauses.push_back({ assumption });
+	squeezedClauseCount = clauses.size();
+	bool result = isSatisfiable(budget ? std::numeric_limits<uint64_t>::max() : MAX_FLIP_NUMBER);
+	clauses.erase(clauses.begin() + clauseCount, clauses.end());
+	squeezedClauseCount = clauseCount;
+	if (result)
+		return Budget::YES;
+	for (auto& clause : clauses)
+		if (clause.empty())
+			return Budget::NO;
+	return Budget::UNKNOWN;
+}
+
+bool WalkSat::getValue(VariableId id) const {
+	auto it = std::lower_bound(originalIds.begin(), originalIds.end(), id);
+	if (it == originalIds.end() || *it != id)
+		return getFreeValue(id);
+	if (model.empty())
+		return false;
+	return model[it - originalIds.begin()];
+}
+
+SatSolver::Stats WalkSat::getStats() const {
+	return stats;
+}
+
+std::string WalkSat::getName() const {
+	return "WalkSAT";
+}
+
+void WalkSat::initOccurrences() {
+	occurrences.assign(originalIds.size() * 2, std::vector<int>());
+	Clause literals;
+	for (int i = 0; i < clauses.size(); i++) {
+		literals = clauses[i];
+		std::sort(literals.begin(), literals.end(), [](const Literal& a, const Literal& b) {
+			return literalIndex(a) < literalIndex(b);
+		});
+		literals.erase(std::unique(literals.begin(), literals.end(), [](const Literal& a, const Literal& b) {
+			return a.varId == b.varId && a.neg == b.neg;
+		}), literals.end());
+		bool tautology = false;
+		for (size_t j = 1; j < literals.size(); j++)
+			if (literals[j].varId == literals[j - 1].varId)
+				tautology = true;
+		if (tautology)
+			continue; // always satisfied, never tracked
+		for (auto& literal : literals)
+			occurrences[literalIndex(literal)].push_back(i);
+	}
+}
+
+void WalkSat::initWalker(Walker& walker) const {
+	const size_t variableCount = originalIds.size();
+	std::uniform_int_distribution<> dist(0, 1);
+	walker.model.resize(variableCount);
+	for (size_t i = 0; i < variableCount; i++)
+		walker.model[i] = dist(walker.gen) != 0;
+	walker.trueLiteralCounts.assign(clauses.size(), 0);
+	walker.unsatClauses.clear();
+	walker.unsatPositions.assign(clauses.size(), -1);
+	walker.clauseWeights.assign(clauses.size(), 1);
+	walker.flipSteps.assign(variableCount, 0);
+	walker.step = 0;
+	walker.weightIncreaseCount = 0;
+	std::vector<bool> tracked(clauses.size());
+	for (size_t index = 0; index < occurrences.size(); index++) {
+		const bool trueLiteral = walker.model[index / 2] != ((index & 1) != 0);
+		for (int clauseIndex : occurrences[index]) {
+			tracked[clauseIndex] = true;
+			if (trueLiteral)
+				walker.trueLiteralCounts[clauseIndex]++;
 		}
-		if (trueSentence)
+	}
+	for (int i = 0; i < clauses.size(); i++)
+		if (tracked[i] && walker.trueLiteralCounts[i] == 0)
+			walker.addUnsatClause(i);
+}
+
+bool WalkSat::walk(Walker& walker, uint64_t flipNumber, float p, int index, std::atomic<int>& winnerIndex) const {
+	const uint64_t BUDGET_CHECK_INTERVAL = 64; // flips charged to the budget at once
+	for (uint64_t i = 0; i < flipNumber; i++) {
+		if (walker.unsatClauses.empty()) {
+			// walkers with a higher index cannot win any more
+			int current = winnerIndex.load();
+			while (index < current && !winnerIndex.compare_exchange_weak(current, index));
 			return true;
+		}
+		if (winnerIndex.load(std::memory_order_relaxed) < index)
+			return false;
+		if (budget && i % BUDGET_CHECK_INTERVAL == 0 && budget->isExceeded(BUDGET_CHECK_INTERVAL)) {
+			walker.interrupted = true;
+			return false;
+		}
 
-		VariableId variableToflip = -1;
-		int randFalseClauseIdx = iDist(gen) % falseClauses.size();
-		Clause& randFalseClause = *falseClauses[randFalseClauseIdx];
-		if (fDist(gen) < randWalkP) {
-			int randLiteralIdx = iDist(gen) % randFalseClause.size();
-			variableToflip = randFalseClause[randLiteralIdx].varId;
+		const Clause& randFalseClause = clauses[walker.unsatClauses[walker.gen() % walker.unsatClauses.size()]];
+		VariableId variableToflip;
+		switch (heuristic) {
+		case PROBSAT:
+			variableToflip = selectProbSat(walker, randFalseClause);
+			break;
+		case NOVELTY_PLUS:
+			variableToflip = selectNoveltyPlus(walker, randFalseClause, p);
+			break;
+		case PAWS:
+			variableToflip = selectPaws(walker, randFalseClause);
+			break;
+		default:
+			variableToflip = selectWalkSat(walker, randFalseClause, p);
 		}
-		else {
-			int bestTrueClauseCount = -1;
-			for (auto& literal : randFalseClause) {
-				VariableId id = literal.varId;
-				model[id] = !model[id];
-				int trueClauseCount = 0;
-				for (auto& clause : clauses) {
-					for (auto& literal : clause) {
-						if (model[literal.varId] != literal.neg) {
-							trueClauseCount++;
-							break;
-						}
-					}
-				}
-				model[id] = !model[id];
-				if (trueClauseCount > bestTrueClauseCount) {
-					variableToflip = id;
-					bestTrueClauseCount = trueClauseCount;
-				}
-			}
+		walker.step++;
+		if (variableToflip != -1) {
+			flip(walker, variableToflip);
+			walker.flipSteps[variableToflip] = walker.step;
+			walker.flipCount++;
 		}
-		assert(variableToflip > -1);
-		model[variableToflip] = !model[variableToflip];
 	}
-	return false;
+	return walker.unsatClauses.empty();
 }
 
-std::vector<bool> WalkSat::getModel() const {
+VariableId WalkSat::selectWalkSat(Walker& walker, const Clause& clause, float p) const {
+	std::uniform_real_distribution<float> fDist(0.f, 1.f);
+	if (fDist(walker.gen) < p)
+		return clause[walker.gen() % clause.size()].varId;
+	VariableId bestId = -1;
+	int bestScore = std::numeric_limits<int>::min();
+	for (auto& literal : clause) {
+		int score = getFlipScore(walker, literal.varId);
+		if (score > bestScore) {
+			bestId = literal.varId;
+			bestScore = score;
+		}
+	}
+	return bestId;
+}
+
+VariableId WalkSat::selectProbSat(Walker& walker, const Clause& clause) const {
+	// polynomial break-only distribution tuned for 3-SAT
+	const double CB = 2.38;
+	const double EPS = 0.9;
+	std::vector<double> probabilities(clause.size());
+	double sum = 0;
+	for (size_t i = 0; i < clause.size(); i++) {
+		probabilities[i] = std::pow(EPS + getBreakCount(walker, clause[i].varId), -CB);
+		sum += probabilities[i];
+	}
+	double value = std::uniform_real_distribution<double>(0, sum)(walker.gen);
+	for (size_t i = 0; i < clause.size(); i++) {
+		value -= probabilities[i];
+		if (value <= 0)
+			return clause[i].varId;
+	}
+	return clause.back().varId;
+}
+
+VariableId WalkSat::selectNoveltyPlus(Walker& walker, const Clause& clause, float p) const {
+	const float WALK_PROBABILITY = 0.01f;
+	std::uniform_real_distribution<float> fDist(0.f, 1.f);
+	if (fDist(walker.gen) < WALK_PROBABILITY)
+		return clause[walker.gen() % clause.size()].varId;
+	// ties are broken in favour of the least recently flipped variable
+	const std::vector<uint64_t>& flipSteps = walker.flipSteps;
+	VariableId bestId = -1;
+	VariableId secondId = -1;
+	VariableId youngestId = clause.front().varId;
+	int bestScore = std::numeric_limits<int>::min();
+	int secondScore = std::numeric_limits<int>::min();
+	for (auto& literal : clause) {
+		VariableId id = literal.varId;
+		if (id == bestId || id == secondId)
+			continue;
+		int score = getFlipScore(walker, id);
+		if (flipSteps[id] > flipSteps[youngestId])
+			youngestId = id;
+		if (score > bestScore || (score == bestScore && flipSteps[id] < flipSteps[bestId])) {
+			secondId = bestId;
+			secondScore = bestScore;
+			bestId = id;
+			bestScore = score;
+		}
+		else if (score > secondScore || (score == secondScore && flipSteps[id] < flipSteps[secondId])) {
+			secondId = id;
+			secondScore = score;
+		}
+	}
+	if (bestId != youngestId || secondId == -1)
+		return bestId;
+	return fDist(walker.gen) < p ? secondId : bestId;
+}
+
+VariableId WalkSat::selectPaws(Walker& walker, const Clause& clause) const {
+	const float FLAT_MOVE_PROBABILITY = 0.15f;
+	const uint64_t DECREASE_INTERVAL = 10;
+	VariableId bestId = -1;
+	int bestScore = std::numeric_limits<int>::min();
+	for (auto& literal : clause) {
+		int score = getFlipScore(walker, literal.varId);
+		if (score > bestScore) {
+			bestId = literal.varId;
+			bestScore = score;
+		}
+	}
+	if (bestScore > 0)
+		return bestId;
+	if (bestScore == 0 && std::uniform_real_distribution<float>(0.f, 1.f)(walker.gen) < FLAT_MOVE_PROBABILITY)
+		return bestId;
+	// local minimum: the unsatisfied clauses get heavier, periodically the satisfied ones lighter
+	for (int clauseIndex : walker.unsatClauses)
+		walker.clauseWeights[clauseIndex]++;
+	if (++walker.weightIncreaseCount % DECREASE_INTERVAL == 0)
+		for (int i = 0; i < clauses.size(); i++)
+			if (walker.clauseWeights[i] > 1 && walker.trueLiteralCounts[i] > 0)
+				walker.clauseWeights[i]--;
+	return -1;
+}
+
+int WalkSat::getFlipScore(const Walker& walker, VariableId id) const {
+	// made minus broken clause weights, the change of the satisfied weight after the flip
+	const int trueIndex = literalIndex(Literal(id, !walker.model[id]));
+	int score = 0;
+	for (int clauseIndex : occurrences[trueIndex ^ 1])
+		if (walker.trueLiteralCounts[clauseIndex] == 0)
+			score += walker.clauseWeights[clauseIndex];
+	for (int clauseIndex : occurrences[trueIndex])
+		if (walker.trueLiteralCounts[clauseIndex] == 1)
+			score -= walker.clauseWeights[clauseIndex];
+	return score;
+}
+
+int WalkSat::getBreakCount(const Walker& walker, VariableId id) const {
+	const int trueIndex = literalIndex(Literal(id, !walker.model[id]));
+	int count = 0;
+	for (int clauseIndex : occurrences[trueIndex])
+		if (walker.trueLiteralCounts[clauseIndex] == 1)
+			count++;
+	return count;
+}
+
+void WalkSat::flip(Walker& walker, VariableId id) const {
+	const int trueIndex = literalIndex(Literal(id, !walker.model[id]));
+	walker.model[id] = !walker.model[id];
+	for (int clauseIndex : occurrences[trueIndex])
+		if (--walker.trueLiteralCounts[clauseIndex] == 0)
+			walker.addUnsatClause(clauseIndex);
+	for (int clauseIndex : occurrences[trueIndex ^ 1])
+		if (walker.trueLiteralCounts[clauseIndex]++ == 0)
+			walker.removeUnsatClause(clauseIndex);
+}
+
+void WalkSat::squeezeAddedClauses() {
+	if (squeezedClauseCount == clauses.size())
+		return;
+	squeezeVariableIds(clauses, originalIds, squeezedClauseCount);
+	squeezedClauseCount = clauses.size();
+}
+
+BitParallelSat::BitParallelSat() : squeezedClauseCount(0), budget(nullptr), interrupted(false) {}
+
+BitParallelSat::BitParallelSat(const Cnf& cnf) : BitParallelSat() {
+	clauses = cnf;
+	squeezeAddedClauses();
+	clauses.shrink_to_fit();
+}
+
+bool BitParallelSat::isSatisfiable() {
+	squeezeAddedClauses();
+	return search(clauses);
+}
+
+bool BitParallelSat::isInterrupted() const {
+	return interrupted;
+}
+
+std::vector<bool> BitParallelSat::getModel() const {
 	return model;
 }
+
+void BitParallelSat::addClause(const Clause& clause) {
+	clauses.push_back(clause);
+}
+
+void BitParallelSat::addCnf(Cnf&& cnf) {
+	if (clauses.empty())
+		clauses = std::move(cnf);
+	else
+		clauses.insert(clauses.end(), std::make_move_iterator(cnf.begin()), std::make_move_iterator(cnf.end()));
+	cnf.clear();
+}
+
+Budget::Answer BitParallelSat::solve(const std::vector<Literal>& assumptions) {
+	squeezeAddedClauses();
+	std::vector<Literal> squeezedAssumptions;
+	if (!squeezeAssumptions(assumptions, originalIds, squeezedAssumptions))
+		return Budget::NO;
+	bool result;
+	if (squeezedAssumptions.empty())
+		result = search(clauses);
+	else {
+		Cnf assumedClauses = clauses;
+		for (auto& assumption : squeezedAssumptions)
+			assumedClauses.push_back({ assumption });
+		result = search(assumedClauses);
+	}
+	if (interrupted)
+		return Budget::UNKNOWN;
+	return Budget::toAnswer(result);
+}
+
+bool BitParallelSat::getValue(VariableId id) const {
+	auto it = std::lower_bound(originalIds.begin(), originalIds.end(), id);
+	if (it == originalIds.end() || *it != id)
+		return getFreeValue(id);
+	if (model.empty())
+		return false;
+	return model[it - originalIds.begin()];
+}
+
+void BitParallelSat::setBudget(Budget* budget) {
+	this->budget = budget;
+}
+
+SatSolver::Stats BitParallelSat::getStats() const {
+	return stats;
+}
+
+std::string BitParallelSat::getName() const {
+	return "Bit-parallel";
+}
+
+void BitParallelSat::squeezeAddedClauses() {
+	if (squeezedClauseCount == clauses.size())
+		return;
+	squeezeVariableIds(clauses, originalIds, squeezedClauseCount);
+	squeezedClauseCount = clauses.size();
+}
+
+bool BitParallelSat::search(const Cnf& clauses) {
+	const int LOG_BIT_COUNT = 6;
+	// bit b of the word of the variable v (v < 6) is bit v of b
+	const uint64_t LOW_VARIABLE_MASKS[LOG_BIT_COUNT] = {
+		0xaaaaaaaaaaaaaaaa, 0xcccccccccccccccc, 0xf0f0f0f0f0f0f0f0,
+		0xff00ff00ff00ff00, 0xffff0000ffff0000, 0xffffffff00000000
+	};
+	interrupted = false;
+	model.clear();
+	const int variableCount = static_cast<int>(originalIds.size());
+	if (variableCount > MAX_VARIABLE_COUNT)
+		throw std::runtime_error("BitParallelSat supports max " + std::to_string(MAX_VARIABLE_COUNT) + " variables");
+
+	const int lowCount = std::min(variableCount, LOG_BIT_COUNT);
+	const uint64_t validMask = lowCount == LOG_BIT_COUNT ? ~static_cast<uint64_t>(0) :
+		(static_cast<uint64_t>(1) << (1 << lowCount)) - 1;
+	const uint64_t batchCount = static_cast<uint64_t>(1) << (variableCount - lowCount);
+	std::vector<uint64_t> values(variableCount);
+	for (int v = 0; v < lowCount; v++)
+		values[v] = LOW_VARIABLE_MASKS[v];
+	for (uint64_t batch = 0; batch < batchCount; batch++) {
+		if (budget && batch % BUDGET_CHECK_INTERVAL == 0 && budget->isExceeded(BUDGET_CHECK_INTERVAL)) {
+			interrupted = true;
+			return false;
+		}
+		for (int v = lowCount; v < variableCount; v++)
+			values[v] = (batch >> (v - lowCount)) & 1 ? ~static_cast<uint64_t>(0) : 0;
+		uint64_t satisfied = validMask;
+		for (auto& clause : clauses) {
+			uint64_t clauseValue = 0;
+			for (auto& literal : clause)
+				clauseValue |= literal.neg ? ~values[literal.varId] : values[literal.varId];
+			satisfied &= clauseValue;
+			if (!satisfied) {
+				stats.conflicts++;
+				break;
+			}
+		}
+		if (satisfied) {
+			int bit = 0;
+			while (!((satisfied >> bit) & 1))
+				bit++;
+			model.resize(variableCount);
+			for (int v = 0; v < variableCount; v++)
+				model[v] = (values[v] >> bit) & 1;
+			return true;
+		}
+	}
+	return false;
+}
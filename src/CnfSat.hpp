@@ -1,39 +1,162 @@
 #pragma once
 
-#include "NormalForm.hpp"
+#include "SatSolver.hpp"
+#include "DratProof.hpp"
 
-class DpllCnfSat {
+#include <cstdint>
+#include <atomic>
+
+class DpllCnfSat : public SatSolver {
 public:
+	DpllCnfSat();
 	DpllCnfSat(const Cnf& cnf);
 	~DpllCnfSat() = default;
 
+	enum Branching { FIRST_UNASSIGNED, MOST_OCCURRENCES };
+	void setBranching(Branching branching, bool firstValue = false);
+	void setBudget(Budget* budget) override; // a DPLL node is a step
+	// DRAT refutation written by isSatisfiable() without assumptions, the pure literal rule is off while set
+	void setProofWriter(DratWriter* proofWriter);
+
 	bool isSatisfiable();
+	bool isSatisfiable(const std::vector<Literal>& assumptions); // squeezed variable ids
+	bool isInterrupted() const; // true if the last search was stopped by the budget
 
 	static bool isPropValid(const PropositionSP& proposition);
 	static bool isPropContradiction(const PropositionSP& proposition);
+	static Budget::Answer isPropValid(const PropositionSP& proposition, Budget& budget);
+	static Budget::Answer isPropContradiction(const PropositionSP& proposition, Budget& budget);
+	// One Tseitin encoding, solved under the output literal and under its negation
+	static Proposition::Validity classifyProp(const PropositionSP& proposition);
+	static Proposition::Validity classifyProp(const PropositionSP& proposition, Budget& budget);
 	std::vector<bool> getModel() const; // squeezed variable ids
 
+	void addClause(const Clause& clause) override;
+	void addCnf(Cnf&& cnf) override;
+	Budget::Answer solve(const std::vector<Literal>& assumptions = {}) override;
+	bool getValue(VariableId id) const override;
+	Stats getStats() const override;
+	std::string getName() const override;
+
 private:
+	static const uint64_t BUDGET_CHECK_INTERVAL = 64; // nodes charged to the budget at once
+
 	Cnf clauses;
+	size_t squeezedClauseCount; // clauses added later have original variable ids
+	std::vector<VariableId> originalIds; // squeezed id -> original id
 	std::vector<bool> variableAssigned;
 	std::vector<bool> variableValues;
 	std::vector<int> negativeLiteralCount;
 	std::vector<int> positiveLiteralCount;
+	Branching branching;
+	bool firstValue;
+	Budget* budget;
+	uint64_t unchargedNodeCount;
+	bool interrupted;
+	DratWriter* proofWriter;
+	Clause proofLemma; // negated assignments of the current path
+	Stats stats;
 
+	void squeezeAddedClauses();
 	bool dpll(VariableId id, bool value);
+	void writeRefutation(const std::vector<Literal>& childLiterals);
 };
 
-class WalkSat {
+class WalkSat : public SatSolver {
 public:
+	WalkSat();
 	WalkSat(const Cnf& cnf);
 	~WalkSat() = default;
 
+	// Variable selection in a random unsatisfied clause:
+	// WALKSAT - random with probability p, otherwise the best make minus break
+	// PROBSAT - random with probability polynomial in the break count, p is not used
+	// NOVELTY_PLUS - the best one unless it was flipped most recently, then the second best with probability p
+	// PAWS - the best improving one over weighted clauses, otherwise the unsatisfied clause weights grow
+	enum Heuristic { WALKSAT, PROBSAT, NOVELTY_PLUS, PAWS };
+	void setHeuristic(Heuristic heuristic);
+	void setSeed(uint64_t seed); // runs with the same seed give the same result, random_device seeds otherwise
+	// Independent walkers search in rounds of restartFlipNumber flips (0 means no restarts) on a thread pool.
+	// Of the walkers which found a model in the first successful round, the one with the lowest index wins.
+	void setWalkers(unsigned walkerCount, uint64_t restartFlipNumber = 0, unsigned threadCount = 0);
+
 	// isSatisfiable returns true if satisfiable and false if probably not
-	bool isSatisfiable(uint64_t maxFlipNumber = 1000, float p = 0.5f);
+	bool isSatisfiable(uint64_t maxFlipNumber = 1000, float p = 0.5f); // per walker, PAWS weight updates count as flips
 	std::vector<bool> getModel() const; // squeezed variable ids
+	void setBudget(Budget* budget) override; // a flip is a step
+
+	// solve() flips until the budget is exceeded, without a budget as many times as isSatisfiable()
+	void addClause(const Clause& clause) override;
+	void addCnf(Cnf&& cnf) override;
+	Budget::Answer solve(const std::vector<Literal>& assumptions = {}) override;
+	bool getValue(VariableId id) const override;
+	Stats getStats() const override;
+	std::string getName() const override;
 
 private:
+	struct Walker;
+
 	Cnf clauses;
+	size_t squeezedClauseCount; // clauses added later have original variable ids
+	std::vector<VariableId> originalIds; // squeezed id -> original id
 	std::vector<bool> model;
-	std::vector<Clause*> falseClauses;
+	Budget* budget;
+	Stats stats;
+	Heuristic heuristic;
+	bool seeded;
+	uint64_t seed;
+	unsigned walkerCount;
+	uint64_t restartFlipNumber;
+	unsigned threadCount;
+	std::vector<std::vector<int>> occurrences; // literal index -> clause indexes, tautologies excluded
+
+	void squeezeAddedClauses();
+	void initOccurrences();
+	void initWalker(Walker& walker) const; // random model
+	bool walk(Walker& walker, uint64_t flipNumber, float p, int index, std::atomic<int>& winnerIndex) const;
+	VariableId selectWalkSat(Walker& walker, const Clause& clause, float p) const;
+	VariableId selectProbSat(Walker& walker, const Clause& clause) const;
+	VariableId selectNoveltyPlus(Walker& walker, const Clause& clause, float p) const;
+	VariableId selectPaws(Walker& walker, const Clause& clause) const; // -1 if the weights were updated instead
+	int getFlipScore(const Walker& walker, VariableId id) const; // weighted make minus break
+	int getBreakCount(const Walker& walker, VariableId id) const;
+	void flip(Walker& walker, VariableId id) const;
+};
+
+/* Exhaustive search for small CNFs: the clauses are evaluated for 64 assignments
+ * at once, one per bit of a word.
+ */
+class BitParallelSat : public SatSolver {
+public:
+	static const int MAX_VARIABLE_COUNT = 40;
+
+	BitParallelSat();
+	BitParallelSat(const Cnf& cnf);
+	~BitParallelSat() = default;
+
+	bool isSatisfiable(); // throws for more than MAX_VARIABLE_COUNT variables
+	bool isInterrupted() const; // true if the last search was stopped by the budget
+	std::vector<bool> getModel() const; // squeezed variable ids
+
+	void addClause(const Clause& clause) override;
+	void addCnf(Cnf&& cnf) override;
+	Budget::Answer solve(const std::vector<Literal>& assumptions = {}) override;
+	bool getValue(VariableId id) const override;
+	void setBudget(Budget* budget) override; // 64 assignments are a step
+	Stats getStats() const override;
+	std::string getName() const override;
+
+private:
+	static const uint64_t BUDGET_CHECK_INTERVAL = 64; // steps charged to the budget at once
+
+	Cnf clauses;
+	size_t squeezedClauseCount; // clauses added later have original variable ids
+	std::vector<VariableId> originalIds; // squeezed id -> original id
+	std::vector<bool> model;
+	Budget* budget;
+	bool interrupted;
+	Stats stats;
+
+	void squeezeAddedClauses();
+	bool search(const Cnf& clauses);
 };
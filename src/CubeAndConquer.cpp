@@ -0,0 +1,251 @@
+#include "CubeAndConquer.hpp"
+
+#include "CnfSat.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace {
+	const int MAX_CUBE_DEPTH = 24;
+	const int MAX_LOOKAHEAD_CANDIDATES = 32;
+
+	inline int literalIndex(const Literal& literal) {
+		return literal.varId * 2 + (literal.neg ? 1 : 0);
+	}
+
+	inline Literal negated(const Literal& literal) {
+		return Literal(literal.varId, !literal.neg);
+	}
+}
+
+struct CubeAndConquerSat::Search {
+	Budget budget; // stopped by the first model
+	std::atomic<uint64_t> cubeCount;
+	std::mutex mutex;
+	bool satisfiable;
+	std::vector<bool> model;
+
+	Search(Budget* parent) : budget(parent), cubeCount(0), satisfiable(false) {}
+
+	void foundModel(const std::vector<bool>& model) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (satisfiable)
+			return;
+		satisfiable = true;
+		this->model = model;
+		budget.stop();
+	}
+};
+
+CubeAndConquerSat::CubeAndConquerSat(const Cnf& cnf, unsigned threadCount) :
+	clauses(cnf), threadCount(threadCount), variableCount(0), cubeCount(0),
+	budget(nullptr), interrupted(false) {
+	squeezeVariableIds(clauses);
+	clauses.shrink_to_fit();
+	for (auto& clause : clauses)
+		for (auto& literal : clause)
+			variableCount = std::max(literal.varId + 1, variableCount);
+	occurrences.resize(variableCount * 2);
+	for (int i = 0; i < clauses.size(); i++)
+		for (auto& literal : clauses[i])
+			occurrences[literalIndex(literal)].push_back(i);
+	for (VariableId id = 0; id < variableCount; id++)
+		candidateOrder.push_back(id);
+	auto occurrenceCount = [this](VariableId id) {
+		return occurrences[id * 2].size() + occurrences[id * 2 + 1].size();
+	};
+	std::stable_sort(candidateOrder.begin(), candidateOrder.end(), [&](VariableId a, VariableId b) {
+		return occurrenceCount(a) > occurrenceCount(b);
+	});
+}
+
+void CubeAndConquerSat::setBudget(Budget* budget) {
+	this->budget = budget;
+}
+
+bool CubeAndConquerSat::isSatisfiable() {
+	model.clear();
+	cubeCount = 0;
+	interrupted = false;
+	for (auto& clause : clauses)
+		if (clause.empty())
+			return false;
+
+	Search search(budget);
+	{
+		ThreadPool pool(threadCount);
+		pool.submit([this, &search, &pool] {
+			processCube(search, pool, std::vector<Literal>(), 0);
+		});
+		pool.wait();
+	}
+	cubeCount = search.cubeCount;
+	model = search.model;
+	interrupted = !search.satisfiable && search.budget.isStopped();
+	return search.satisfiable;
+}
+
+bool CubeAndConquerSat::isInterrupted() const {
+	return interrupted;
+}
+
+std::vector<bool> CubeAndConquerSat::getModel() const {
+	return model;
+}
+
+uint64_t CubeAndConquerSat::getCubeCount() const {
+	return cubeCount;
+}
+
+void CubeAndConquerSat::processCube(Search& search, ThreadPool& pool,
+	                                std::vector<Literal> cube, int depth) const {
+	if (search.budget.isExceeded(0))
+		return;
+
+	std::vector<int8_t> values(variableCount, -1);
+	std::vector<Literal> trail;
+	for (auto& literal : cube)
+		if (!assign(values, trail, literal))
+			return; // refuted cube
+	if (!propagate(values, trail, 0))
+		return;
+
+	if (depth < MAX_CUBE_DEPTH && pool.getPendingCount() < pool.getThreadCount()) {
+		Literal branch(-1, false);
+		if (!lookahead(values, trail, branch))
+			return; // refuted by failed literals
+		if (branch.varId == -1) {
+			std::vector<bool> model(variableCount);
+			for (VariableId id = 0; id < variableCount; id++)
+				model[id] = values[id] == 1;
+			search.foundModel(model);
+			return;
+		}
+		for (int i = 0; i < 2; i++) {
+			std::vector<Literal> childCube = trail;
+			childCube.push_back(i == 0 ? branch : negated(branch));
+			pool.submit([this, &search, &pool, childCube, depth] {
+				processCube(search, pool, childCube, depth + 1);
+			});
+		}
+		return;
+	}
+
+	search.cubeCount++;
+	DpllCnfSat dpll(clauses);
+	dpll.setBudget(&search.budget);
+	if (dpll.isSatisfiable(trail) && !dpll.isInterrupted())
+		search.foundModel(dpll.getModel());
+}
+
+bool CubeAndConquerSat::lookahead(std::vector<int8_t>& values, std::vector<Literal>& trail,
+	                              Literal& branch) const {
+	branch = Literal(-1, false);
+	if (isSatisfied(values))
+		return true;
+
+	bool forced = true;
+	while (forced) {
+		forced = false;
+		uint64_t bestScore = 0;
+		int candidateCount = 0;
+		for (VariableId id : candidateOrder) {
+			if (values[id] >= 0)
+				continue;
+			if (candidateCount++ == MAX_LOOKAHEAD_CANDIDATES)
+				break;
+			uint64_t propagated[2];
+			bool failed[2];
+			for (int i = 0; i < 2; i++) {
+				size_t size = trail.size();
+				failed[i] = !assign(values, trail, Literal(id, i == 1)) || !propagate(values, trail, size);
+				propagated[i] = trail.size() - size;
+				unassign(values, trail, size);
+			}
+			if (failed[0] && failed[1])
+				return false;
+			if (failed[0] || failed[1]) {
+				// failed literal, the opposite one is implied
+				size_t size = trail.size();
+				if (!assign(values, trail, Literal(id, !failed[1])) || !propagate(values, trail, size))
+					return false;
+				forced = true;
+				break;
+			}
+			uint64_t score = (propagated[0] + 1) * (propagated[1] + 1);
+			if (score > bestScore) {
+				bestScore = score;
+				branch = Literal(id, propagated[0] < propagated[1]);
+			}
+		}
+		if (forced && isSatisfied(values)) {
+			branch = Literal(-1, false);
+			return true;
+		}
+	}
+	return true;
+}
+
+bool CubeAndConquerSat::assign(std::vector<int8_t>& values, std::vector<Literal>& trail,
+	                           Literal literal) const {
+	int8_t value = literal.neg ? 0 : 1;
+	if (values[literal.varId] >= 0)
+		return values[literal.varId] == value;
+	values[literal.varId] = value;
+	trail.push_back(literal);
+	return true;
+}
+
+bool CubeAndConquerSat::propagate(std::vector<int8_t>& values, std::vector<Literal>& trail,
+	                              size_t head) const {
+	while (head < trail.size()) {
+		Literal falseLiteral = negated(trail[head++]);
+		for (int clauseIndex : occurrences[literalIndex(falseLiteral)]) {
+			int unassignedCount = 0;
+			Literal unit(-1, false);
+			bool satisfied = false;
+			for (auto& literal : clauses[clauseIndex]) {
+				int8_t value = values[literal.varId];
+				if (value < 0) {
+					unassignedCount++;
+					unit = literal;
+				}
+				else if ((value == 1) != literal.neg) {
+					satisfied = true;
+					break;
+				}
+			}
+			if (satisfied)
+				continue;
+			if (unassignedCount == 0)
+				return false; // conflict
+			if (unassignedCount == 1)
+				assign(values, trail, unit);
+		}
+	}
+	return true;
+}
+
+void CubeAndConquerSat::unassign(std::vector<int8_t>& values, std::vector<Literal>& trail,
+	                             size_t size) const {
+	for (size_t i = size; i < trail.size(); i++)
+		values[trail[i].varId] = -1;
+	trail.erase(trail.begin() + size, trail.end());
+}
+
+bool CubeAndConquerSat::isSatisfied(const std::vector<int8_t>& values) const {
+	for (auto& clause : clauses) {
+		bool satisfied = false;
+		for (auto& literal : clause) {
+			int8_t value = values[literal.varId];
+			if (value >= 0 && (value == 1) != literal.neg) {
+				satisfied = true;
+				break;
+			}
+		}
+		if (!satisfied)
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "NormalForm.hpp"
+#include "Budget.hpp"
+
+#include <cstdint>
+
+class ThreadPool;
+
+/* Cube-and-conquer SAT solving. Lookahead splits the problem into cubes
+ * (partial assignments) which are solved by DPLL on a work-stealing thread pool.
+ * A cube is split further instead of being solved while workers would be idle.
+ * The first model found stops all workers.
+ */
+class CubeAndConquerSat {
+public:
+	CubeAndConquerSat(const Cnf& cnf, unsigned threadCount = 0); // 0 means one thread per hardware thread
+	~CubeAndConquerSat() = default;
+
+	void setBudget(Budget* budget); // shared by all workers, DPLL nodes are steps
+	bool isSatisfiable();
+	bool isInterrupted() const; // true if the last search was stopped by the budget
+	std::vector<bool> getModel() const; // squeezed variable ids
+	uint64_t getCubeCount() const; // number of cubes solved by DPLL in the last search
+
+private:
+	struct Search;
+
+	Cnf clauses;
+	unsigned threadCount;
+	int variableCount;
+	std::vector<std::vector<int>> occurrences; // literal index -> clause indexes
+	std::vector<VariableId> candidateOrder; // variables sorted by occurrence count
+	std::vector<bool> model;
+	uint64_t cubeCount;
+	Budget* budget;
+	bool interrupted;
+
+	void processCube(Search& search, ThreadPool& pool, std::vector<Literal> cube, int depth) const;
+	bool lookahead(std::vector<int8_t>& values, std::vector<Literal>& trail, Literal& branch) const;
+	bool assign(std::vector<int8_t>& values, std::vector<Literal>& trail, Literal literal) const;
+	bool propagate(std::vector<int8_t>& values, std::vector<Literal>& trail, size_t head) const;
+	void unassign(std::vector<int8_t>& values, std::vector<Literal>& trail, size_t size) const;
+	bool isSatisfied(const std::vector<int8_t>& values) const;
+};
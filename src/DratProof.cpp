@@ -0,0 +1,242 @@
+#include "DratProof.hpp"
+
+#include <algorithm>
+
+namespace {
+	inline int literalIndex(const Literal& literal) {
+		return literal.varId * 2 + (literal.neg ? 1 : 0);
+	}
+
+	inline Literal negated(const Literal& literal) {
+		return Literal(literal.varId, !literal.neg);
+	}
+}
+
+DratWriter::DratWriter(std::ostream& out) : out(out), lemmaCount(0) {
+	buffer.reserve(BUFFER_SIZE);
+}
+
+DratWriter::~DratWriter() {
+	flush();
+}
+
+void DratWriter::addClause(const Clause& clause) {
+	lemmaCount++;
+	write('a', clause);
+}
+
+void DratWriter::deleteClause(const Clause& clause) {
+	write('d', clause);
+}
+
+void DratWriter::flush() {
+	if (!buffer.empty()) {
+		out.write(buffer.data(), buffer.size());
+		buffer.clear();
+	}
+	out.flush();
+}
+
+uint64_t DratWriter::getLemmaCount() const {
+	return lemmaCount;
+}
+
+void DratWriter::write(char type, const Clause& clause) {
+	// at most 5 bytes per literal plus the type and the terminating zero
+	if (buffer.size() + clause.size() * 5 + 2 > BUFFER_SIZE)
+		flush();
+	buffer.push_back(type);
+	for (auto& literal : clause) {
+		uint32_t code = 2 * (literal.varId + 1) + (literal.neg ? 1 : 0);
+		while (code > 127) {
+			buffer.push_back(static_cast<char>(0x80 | (code & 0x7f)));
+			code >>= 7;
+		}
+		buffer.push_back(static_cast<char>(code));
+	}
+	buffer.push_back(0);
+}
+
+DratChecker::DratChecker(const Cnf& cnf) : checkedLemmaCount(0) {
+	Cnf squeezed = cnf;
+	squeezeVariableIds(squeezed);
+	for (auto& clause : squeezed)
+		addClause(clause);
+}
+
+bool DratChecker::check(std::istream& proof) {
+	checkedLemmaCount = 0;
+	Clause clause;
+	for (;;) {
+		int type = proof.get();
+		if (type == std::char_traits<char>::eof())
+			return false; // no empty clause derived
+		if (!readClause(proof, clause))
+			return false;
+		for (auto& literal : clause)
+			reserveVariable(literal.varId);
+		if (type == 'a') {
+			if (!isRup(clause) && !isRat(clause))
+				return false;
+			checkedLemmaCount++;
+			if (clause.empty())
+				return true;
+			addClause(clause);
+		}
+		else if (type == 'd')
+			deleteClause(clause); // deletion of an unknown clause is ignored
+		else
+			return false;
+	}
+}
+
+uint64_t DratChecker::getCheckedLemmaCount() const {
+	return checkedLemmaCount;
+}
+
+void DratChecker::addClause(const Clause& clause) {
+	int index = static_cast<int>(clauses.size());
+	for (auto& literal : clause) {
+		reserveVariable(literal.varId);
+		occurrences[literalIndex(literal)].push_back(index);
+	}
+	clauses.push_back(clause);
+	deleted.push_back(false);
+	clauseIndexes[getKey(clause)].push_back(index);
+}
+
+bool DratChecker::deleteClause(const Clause& clause) {
+	auto it = clauseIndexes.find(getKey(clause));
+	if (it == clauseIndexes.end())
+		return false;
+	deleted[it->second.back()] = true;
+	it->second.pop_back();
+	if (it->second.empty())
+		clauseIndexes.erase(it);
+	return true;
+}
+
+void DratChecker::reserveVariable(VariableId id) {
+	if (id >= static_cast<VariableId>(values.size())) {
+		values.resize(id + 1, -1);
+		occurrences.resize((id + 1) * 2);
+	}
+}
+
+bool DratChecker::isRup(const Clause& clause) {
+	unassignAll();
+	bool conflict = false;
+	for (auto& literal : clause) {
+		if (!assign(negated(literal))) {
+			conflict = true; // tautology
+			break;
+		}
+	}
+	if (!conflict) {
+		// empty and unit clauses are not reached through the occurrence lists
+		for (int i = 0; i < clauses.size() && !conflict; i++) {
+			if (deleted[i] || clauses[i].size() > 1)
+				continue;
+			conflict = clauses[i].empty() || !assign(clauses[i].front());
+		}
+	}
+	if (!conflict)
+		conflict = !propagate();
+	unassignAll();
+	return conflict;
+}
+
+bool DratChecker::isRat(const Clause& clause) {
+	if (clause.empty())
+		return false;
+	const Literal pivot = clause.front();
+	std::vector<int> candidates = occurrences[literalIndex(negated(pivot))];
+	for (int index : candidates) {
+		if (deleted[index])
+			continue;
+		Clause resolvent = clause;
+		for (auto& literal : clauses[index])
+			if (literal.varId != pivot.varId)
+				resolvent.push_back(literal);
+		if (!isRup(resolvent))
+			return false;
+	}
+	return true;
+}
+
+bool DratChecker::assign(Literal literal) {
+	int8_t value = literal.neg ? 0 : 1;
+	if (values[literal.varId] >= 0)
+		return values[literal.varId] == value;
+	values[literal.varId] = value;
+	trail.push_back(literal);
+	return true;
+}
+
+bool DratChecker::propagate() {
+	size_t head = 0;
+	while (head < trail.size()) {
+		Literal falseLiteral = negated(trail[head++]);
+		for (int index : occurrences[literalIndex(falseLiteral)]) {
+			if (deleted[index])
+				continue;
+			int unassignedCount = 0;
+			Literal unit(-1, false);
+			bool satisfied = false;
+			for (auto& literal : clauses[index]) {
+				int8_t value = values[literal.varId];
+				if (value < 0) {
+					unassignedCount++;
+					unit = literal;
+				}
+				else if ((value == 1) != literal.neg) {
+					satisfied = true;
+					break;
+				}
+			}
+			if (satisfied)
+				continue;
+			if (unassignedCount == 0)
+				return false; // conflict
+			if (unassignedCount == 1)
+				assign(unit);
+		}
+	}
+	return true;
+}
+
+void DratChecker::unassignAll() {
+	for (auto& literal : trail)
+		values[literal.varId] = -1;
+	trail.clear();
+}
+
+bool DratChecker::readClause(std::istream& proof, Clause& clause) {
+	clause.clear();
+	for (;;) {
+		uint32_t code = 0;
+		int shift = 0;
+		int byte;
+		do {
+			byte = proof.get();
+			if (byte == std::char_traits<char>::eof() || shift > 28)
+				return false;
+			code |= static_cast<uint32_t>(byte & 0x7f) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+		if (code == 0)
+			return true;
+		if (code < 2)
+			return false;
+		clause.push_back(Literal(static_cast<VariableId>(code / 2 - 1), (code & 1) != 0));
+	}
+}
+
+std::vector<int> DratChecker::getKey(const Clause& clause) {
+	std::vector<int> key;
+	for (auto& literal : clause)
+		key.push_back(literalIndex(literal));
+	std::sort(key.begin(), key.end());
+	key.erase(std::unique(key.begin(), key.end()), key.end());
+	return key;
+}
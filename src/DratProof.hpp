@@ -0,0 +1,65 @@
+#pragma once
+
+#include "NormalForm.hpp"
+
+#include <map>
+#include <ostream>
+#include <istream>
+
+/* Buffered writer of binary DRAT proofs. A lemma is written as 'a', the
+ * variable-length encoded literals and a terminating zero, a deletion as 'd'
+ * followed by the same. Literal of the variable id v (0-based) is encoded as
+ * 2 * (v + 1) + (negative ? 1 : 0).
+ */
+class DratWriter {
+public:
+	DratWriter(std::ostream& out);
+	~DratWriter();
+
+	void addClause(const Clause& clause);
+	void deleteClause(const Clause& clause);
+	void flush();
+	uint64_t getLemmaCount() const;
+
+private:
+	static const size_t BUFFER_SIZE = 1 << 16;
+
+	std::ostream& out;
+	std::vector<char> buffer;
+	uint64_t lemmaCount;
+
+	void write(char type, const Clause& clause);
+};
+
+/* Forward checker of binary DRAT proofs. Every added lemma has to be RUP,
+ * or RAT on its first literal, with respect to the clauses currently alive.
+ * The proof is accepted if it derives the empty clause.
+ */
+class DratChecker {
+public:
+	DratChecker(const Cnf& cnf); // variable ids are squeezed like in DpllCnfSat
+	~DratChecker() = default;
+
+	bool check(std::istream& proof);
+	uint64_t getCheckedLemmaCount() const;
+
+private:
+	Cnf clauses; // all clauses ever added, deleted ones are flagged
+	std::vector<bool> deleted;
+	std::vector<std::vector<int>> occurrences; // clause indexes by literal index
+	std::map<std::vector<int>, std::vector<int>> clauseIndexes; // sorted literal indexes -> alive clause indexes
+	std::vector<int8_t> values;
+	std::vector<Literal> trail;
+	uint64_t checkedLemmaCount;
+
+	void addClause(const Clause& clause);
+	bool deleteClause(const Clause& clause);
+	void reserveVariable(VariableId id);
+	bool isRup(const Clause& clause);
+	bool isRat(const Clause& clause);
+	bool assign(Literal literal);
+	bool propagate();
+	void unassignAll();
+	static bool readClause(std::istream& proof, Clause& clause);
+	static std::vector<int> getKey(const Clause& clause);
+};
@@ -0,0 +1,132 @@
+#include "Fingerprint.hpp"
+
+#include <algorithm>
+
+namespace {
+	const int LOG_BIT_COUNT = 6;
+	const int BIT_COUNT = 1 << LOG_BIT_COUNT;
+	const int SIGNATURE_WORD_COUNTS[] = { 1, 8 }; // per width
+	// the values of the first LOG_BIT_COUNT variables, bit i of a word for the assignment i
+	const uint64_t BIT_PATTERNS[LOG_BIT_COUNT] = {
+		0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+		0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+	};
+
+	uint64_t splitMix64(uint64_t x) {
+		x += 0x9E3779B97F4A7C15ull;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+		return x ^ (x >> 31);
+	}
+}
+
+Fingerprint::Fingerprint(const PropositionSP& proposition, Width width, uint64_t seed) : exact(false) {
+	std::vector<int> variableIds;
+	proposition->getVariableIds(variableIds);
+	std::sort(variableIds.begin(), variableIds.end());
+	std::vector<uint64_t> varValues(variableIds.empty() ? 0 : variableIds.back() + 1);
+	for (int word = 0; word < SIGNATURE_WORD_COUNTS[width]; word++) {
+		for (int id : variableIds)
+			varValues[id] = splitMix64(splitMix64(seed + static_cast<uint64_t>(id)) + static_cast<uint64_t>(word));
+		signature.push_back(proposition->evaluate(varValues));
+	}
+	if (variableIds.size() <= MAX_EXACT_VARIABLE_COUNT)
+		computeTruthTable(proposition, variableIds);
+}
+
+void Fingerprint::computeTruthTable(const PropositionSP& proposition, const std::vector<int>& variableIds) {
+	// the full table first, 64 assignments per evaluation as in NaiveModelChecker
+	const int variableCount = static_cast<int>(variableIds.size());
+	const size_t wordCount = variableCount > LOG_BIT_COUNT ?
+		static_cast<size_t>(1) << (variableCount - LOG_BIT_COUNT) : 1;
+	const uint64_t usedBits = variableCount >= LOG_BIT_COUNT ? ~static_cast<uint64_t>(0) :
+		(static_cast<uint64_t>(1) << (1 << variableCount)) - 1;
+	std::vector<uint64_t> varValues(variableIds.empty() ? 0 : variableIds.back() + 1);
+	for (int i = 0; i < LOG_BIT_COUNT && i < variableCount; i++)
+		varValues[variableIds[i]] = BIT_PATTERNS[i];
+	std::vector<uint64_t> table(wordCount);
+	for (size_t word = 0; word < wordCount; word++) {
+		for (int i = LOG_BIT_COUNT; i < variableCount; i++)
+			varValues[variableIds[i]] = (word >> (i - LOG_BIT_COUNT)) & 1 ? ~static_cast<uint64_t>(0) : 0;
+		table[word] = proposition->evaluate(varValues) & usedBits;
+	}
+
+	// a variable is essential if its cofactors differ
+	std::vector<int> essentialIndexes;
+	for (int i = 0; i < variableCount; i++) {
+		bool essential = false;
+		if (i < LOG_BIT_COUNT) {
+			for (size_t word = 0; word < wordCount && !essential; word++)
+				essential = ((table[word] >> (1 << i)) ^ table[word]) & ~BIT_PATTERNS[i] & usedBits;
+		}
+		else {
+			const size_t stride = static_cast<size_t>(1) << (i - LOG_BIT_COUNT);
+			for (size_t word = 0; word < wordCount && !essential; word++)
+				essential = (word & stride) == 0 && table[word] != table[word + stride];
+		}
+		if (essential) {
+			essentialIndexes.push_back(i);
+			essentialVariableIds.push_back(variableIds[i]);
+		}
+	}
+
+	// the table restricted to the essential variables, the others are 0
+	const int essentialCount = static_cast<int>(essentialIndexes.size());
+	if (essentialCount == variableCount)
+		truthTable = table;
+	else {
+		const uint64_t assignmentCount = static_cast<uint64_t>(1) << essentialCount;
+		truthTable.assign(essentialCount > LOG_BIT_COUNT ? assignmentCount / BIT_COUNT : 1, 0);
+		for (uint64_t assignment = 0; assignment < assignmentCount; assignment++) {
+			uint64_t index = 0;
+			for (int j = 0; j < essentialCount; j++)
+				if ((assignment >> j) & 1)
+					index |= static_cast<uint64_t>(1) << essentialIndexes[j];
+			if ((table[index / BIT_COUNT] >> (index % BIT_COUNT)) & 1)
+				truthTable[assignment / BIT_COUNT] |= static_cast<uint64_t>(1) << (assignment % BIT_COUNT);
+		}
+	}
+	exact = true;
+}
+
+bool Fingerprint::isExact() const {
+	return exact;
+}
+
+Budget::Answer Fingerprint::isEquivalent(const Fingerprint& other) const {
+	if (exact && other.exact)
+		return Budget::toAnswer(essentialVariableIds == other.essentialVariableIds && truthTable == other.truthTable);
+	return signature == other.signature ? Budget::UNKNOWN : Budget::NO;
+}
+
+bool Fingerprint::operator==(const Fingerprint& other) const {
+	return signature == other.signature;
+}
+
+bool Fingerprint::operator!=(const Fingerprint& other) const {
+	return !(*this == other);
+}
+
+size_t Fingerprint::getHash() const {
+	// the signature only, as operator==
+	uint64_t hash = 0;
+	for (uint64_t word : signature)
+		hash = splitMix64(hash ^ word);
+	return static_cast<size_t>(hash);
+}
+
+const std::vector<uint64_t>& Fingerprint::getSignature() const {
+	return signature;
+}
+
+const std::vector<uint64_t>& Fingerprint::getTruthTable() const {
+	return truthTable;
+}
+
+const std::vector<int>& Fingerprint::getEssentialVariableIds() const {
+	return essentialVariableIds;
+}
+
+size_t Fingerprint::Hash::operator()(const Fingerprint& fingerprint) const {
+	return fingerprint.getHash();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Proposition.hpp"
+#include "Budget.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/* Semantic fingerprint of a proposition: its values under fixed pseudo-random assignments,
+ * 64 or 512 of them evaluated as the bits of words. The pattern of a variable depends only
+ * on its id and the seed, so equivalent propositions get equal signatures even over
+ * different variables and can be bucketed by hash; only fingerprints of the same width and
+ * seed are comparable. With at most 16 variables the exact truth table over the variables
+ * the proposition depends on is kept as well, two exact fingerprints decide equivalence.
+ */
+class Fingerprint {
+public:
+	static const int MAX_EXACT_VARIABLE_COUNT = 16;
+	static const uint64_t DEFAULT_SEED = 0x2545F4914F6CDD1Dull;
+
+	enum Width { BITS_64, BITS_512 };
+
+	Fingerprint(const PropositionSP& proposition, Width width = BITS_64, uint64_t seed = DEFAULT_SEED);
+	~Fingerprint() = default;
+
+	bool isExact() const;
+	// YES or NO if both are exact, otherwise NO for different signatures and UNKNOWN for equal ones
+	Budget::Answer isEquivalent(const Fingerprint& other) const;
+	bool operator==(const Fingerprint& other) const; // equal signatures, transitive unlike isEquivalent
+	bool operator!=(const Fingerprint& other) const;
+	size_t getHash() const;
+
+	const std::vector<uint64_t>& getSignature() const;
+	// Bit i is the value for the assignment with the value of the j-th essential variable in bit j of i
+	const std::vector<uint64_t>& getTruthTable() const; // empty if not exact
+	const std::vector<int>& getEssentialVariableIds() const; // increasing, empty if not exact
+
+	struct Hash {
+		size_t operator()(const Fingerprint& fingerprint) const;
+	};
+
+private:
+	std::vector<uint64_t> signature;
+	bool exact;
+	std::vector<uint64_t> truthTable;
+	std::vector<int> essentialVariableIds;
+
+	void computeTruthTable(const PropositionSP& proposition, const std::vector<int>& variableIds);
+};
@@ -8,12 +8,85 @@
 #include <cassert>
 #include <stdexcept>
 #include <algorithm>
+#include <bit>
 
-bool NaiveModelChecker::isValid(const PropositionSP& proposition) const {
+namespace {
 	const int BIT_COUNT = sizeof(uint64_t) * 8;
 	const int LOG_BIT_COUNT = 6;
-	assert((1 << LOG_BIT_COUNT) == BIT_COUNT);
+	static_assert((1 << LOG_BIT_COUNT) == BIT_COUNT, "an assignment per bit");
+
+	// The first LOG_BIT_COUNT variables take their values from the bit index, the others from the block
+	void setBitPatterns(std::vector<uint64_t>& varValues, const std::vector<int>& variableIds) {
+		for (int i = 0; i < LOG_BIT_COUNT && i < variableIds.size(); i++) {
+			uint64_t mask = 0;
+			for (uint64_t model = 0; model < BIT_COUNT; model++) {
+				bool varValue = (model & (static_cast<uint64_t>(1) << i)) != 0;
+				if (varValue)
+					mask |= (static_cast<uint64_t>(1) << model);
+			}
+			varValues[variableIds[i]] = mask;
+		}
+	}
+
+	void decodeAssignment(NaiveModelChecker::Assignment& assignment, const std::vector<int>& variableIds,
+		                  uint64_t model) {
+		assignment.clear();
+		for (int i = 0; i < variableIds.size(); i++)
+			assignment.push_back({ variableIds[i], (model & (static_cast<uint64_t>(1) << i)) != 0 });
+	}
+}
+
+bool NaiveModelChecker::isValid(const PropositionSP& proposition) const {
+	return check(proposition, nullptr) == Budget::YES;
+}
+
+bool NaiveModelChecker::isValid(const PropositionSP& proposition, Assignment& counterexample) const {
+	bool someTrue = false;
+	bool someFalse = false;
+	enumerate(proposition, nullptr, false, someTrue, someFalse, &counterexample);
+	return !someFalse;
+}
+
+bool NaiveModelChecker::isContradiction(const PropositionSP& proposition) const {
+	auto notProposition = std::make_shared<UnaryOperator>(proposition, UnaryOperator::NOT);
+	return isValid(notProposition);
+}
+
+Budget::Answer NaiveModelChecker::isValid(const PropositionSP& proposition, Budget& budget) const {
+	return check(proposition, &budget);
+}
+
+Budget::Answer NaiveModelChecker::isContradiction(const PropositionSP& proposition, Budget& budget) const {
+	auto notProposition = std::make_shared<UnaryOperator>(proposition, UnaryOperator::NOT);
+	return isValid(notProposition, budget);
+}
+
+Proposition::Validity NaiveModelChecker::classify(const PropositionSP& proposition,
+	                                                Assignment* counterexample) const {
+	bool someTrue = false;
+	bool someFalse = false;
+	enumerate(proposition, nullptr, true, someTrue, someFalse, counterexample);
+	return !someFalse ? Proposition::VALID : (someTrue ? Proposition::CONTINGENT : Proposition::CONTRADICTION);
+}
 
+Proposition::Validity NaiveModelChecker::classify(const PropositionSP& proposition, Budget& budget) const {
+	bool someTrue = false;
+	bool someFalse = false;
+	if (!enumerate(proposition, &budget, true, someTrue, someFalse))
+		return Proposition::UNDECIDED;
+	return !someFalse ? Proposition::VALID : (someTrue ? Proposition::CONTINGENT : Proposition::CONTRADICTION);
+}
+
+Budget::Answer NaiveModelChecker::check(const PropositionSP& proposition, Budget* budget) const {
+	bool someTrue = false;
+	bool someFalse = false;
+	if (!enumerate(proposition, budget, false, someTrue, someFalse))
+		return Budget::UNKNOWN;
+	return Budget::toAnswer(!someFalse);
+}
+
+bool NaiveModelChecker::enumerate(const PropositionSP& proposition, Budget* budget, bool untilTrue,
+	                              bool& someTrue, bool& someFalse, Assignment* counterexample) const {
 	std::vector<int> variableIds;
 	proposition->getVariableIds(variableIds);
 	std::sort(variableIds.begin(), variableIds.end());
@@ -22,8 +95,13 @@ bool NaiveModelChecker::isValid(const PropositionSP& proposition) const {
 	const uint64_t modelCount = (static_cast<uint64_t>(1) << variableIds.size());
 
 	std::vector<uint64_t> varValues;
-	if (variableIds.empty())
-		return proposition->evaluate(varValues) != 0;
+	if (variableIds.empty()) {
+		someTrue = proposition->evaluate(varValues) != 0;
+		someFalse = !someTrue;
+		if (someFalse && counterexample)
+			counterexample->clear();
+		return true;
+	}
 
 	assert(*std::min_element(variableIds.begin(), variableIds.end()) >= 0);
 	int maxId = *std::max_element(variableIds.begin(), variableIds.end());
@@ -31,37 +109,75 @@ bool NaiveModelChecker::isValid(const PropositionSP& proposition) const {
 
 	if (variableIds.size() < LOG_BIT_COUNT) {
 		for (uint64_t model = 0; model < modelCount; model++) {
+			if (budget && budget->isExceeded())
+				return false;
 			for (int i = 0; i < variableIds.size(); i++) {
 				bool varValue = (model & (static_cast<uint64_t>(1) << i)) != 0;
 				varValues[variableIds[i]] = varValue ? ULLONG_MAX : 0;
 			}
-			if (proposition->evaluate(varValues) == 0)
-				return false;
+			if (proposition->evaluate(varValues) != 0)
+				someTrue = true;
+			else if (!someFalse) {
+				someFalse = true;
+				if (counterexample)
+					decodeAssignment(*counterexample, variableIds, model);
+			}
+			if (someFalse && (someTrue || !untilTrue))
+				return true;
 		}
 	}
 	else {
-		for (int i = 0; i < LOG_BIT_COUNT; i++) {
-			uint64_t mask = 0;
-			for (uint64_t model = 0; model < BIT_COUNT; model++) {
-				bool varValue = (model & (static_cast<uint64_t>(1) << i)) != 0;
-				if (varValue)
-					mask |= (static_cast<uint64_t>(1) << model);
-			}
-			varValues[variableIds[i]] = mask;
-		}
+		setBitPatterns(varValues, variableIds);
 		for (uint64_t model = 0; model < modelCount; model += BIT_COUNT) {
+			if (budget && budget->isExceeded())
+				return false;
 			for (int i = LOG_BIT_COUNT; i < variableIds.size(); i++) {
 				bool varValue = (model & (static_cast<uint64_t>(1) << i)) != 0;
 				varValues[variableIds[i]] = varValue ? ULLONG_MAX : 0;
 			}
-			if (proposition->evaluate(varValues) != ULLONG_MAX)
-				return false;
+			const uint64_t values = proposition->evaluate(varValues);
+			someTrue = someTrue || values != 0;
+			if (!someFalse && values != ULLONG_MAX) {
+				someFalse = true;
+				if (counterexample)
+					decodeAssignment(*counterexample, variableIds, model + std::countr_zero(~values));
+			}
+			if (someFalse && (someTrue || !untilTrue))
+				return true;
 		}
 	}
 	return true;
 }
 
-bool NaiveModelChecker::isContradiction(const PropositionSP& proposition) const {
-	auto notProposition = std::make_shared<UnaryOperator>(proposition, UnaryOperator::NOT);
-	return isValid(notProposition);
+CounterexampleIterator::CounterexampleIterator(const PropositionSP& proposition) : proposition(proposition),
+	                                                                              nextBlock(0), block(0), falsified(0) {
+	proposition->getVariableIds(variableIds);
+	std::sort(variableIds.begin(), variableIds.end());
+	if (variableIds.size() > BIT_COUNT)
+		throw std::runtime_error("CounterexampleIterator supports max 64 variables");
+	blockCount = variableIds.size() > LOG_BIT_COUNT ?
+		static_cast<uint64_t>(1) << (variableIds.size() - LOG_BIT_COUNT) : 1;
+	if (!variableIds.empty())
+		varValues = std::vector<uint64_t>(*std::max_element(variableIds.begin(), variableIds.end()) + 1);
+	setBitPatterns(varValues, variableIds);
+}
+
+bool CounterexampleIterator::next(NaiveModelChecker::Assignment& counterexample) {
+	// fewer than LOG_BIT_COUNT variables leave the bits of the nonexistent assignments out
+	const uint64_t usedBits = variableIds.size() >= LOG_BIT_COUNT ? ULLONG_MAX :
+		(static_cast<uint64_t>(1) << (static_cast<uint64_t>(1) << variableIds.size())) - 1;
+	while (falsified == 0) {
+		if (nextBlock == blockCount)
+			return false;
+		block = nextBlock++;
+		for (int i = LOG_BIT_COUNT; i < variableIds.size(); i++) {
+			bool varValue = (block & (static_cast<uint64_t>(1) << (i - LOG_BIT_COUNT))) != 0;
+			varValues[variableIds[i]] = varValue ? ULLONG_MAX : 0;
+		}
+		falsified = ~proposition->evaluate(varValues) & usedBits;
+	}
+	const int bit = std::countr_zero(falsified);
+	falsified &= falsified - 1;
+	decodeAssignment(counterexample, variableIds, block * BIT_COUNT + bit);
+	return true;
 }
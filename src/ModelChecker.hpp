@@ -1,9 +1,51 @@
 #pragma once
 
 #include "Proposition.hpp"
+#include "Budget.hpp"
+
+#include <vector>
+#include <utility>
+#include <cstdint>
 
 class NaiveModelChecker {
 public:
+	typedef std::vector<std::pair<int, bool>> Assignment; // variable id and value, in increasing id order
+
 	bool isValid(const PropositionSP& proposition) const;
+	// The first falsifying assignment in the enumeration order is the counterexample if not valid
+	bool isValid(const PropositionSP& proposition, Assignment& counterexample) const;
 	bool isContradiction(const PropositionSP& proposition) const;
+	// An evaluation of up to 64 models is a step
+	Budget::Answer isValid(const PropositionSP& proposition, Budget& budget) const;
+	Budget::Answer isContradiction(const PropositionSP& proposition, Budget& budget) const;
+	// Both questions in one enumeration, which stops once a true and a false model were seen
+	Proposition::Validity classify(const PropositionSP& proposition, Assignment* counterexample = nullptr) const;
+	Proposition::Validity classify(const PropositionSP& proposition, Budget& budget) const;
+
+private:
+	Budget::Answer check(const PropositionSP& proposition, Budget* budget) const;
+	// Stops at the first false model, or once both were seen if untilTrue; false if the budget was exceeded
+	bool enumerate(const PropositionSP& proposition, Budget* budget, bool untilTrue,
+	               bool& someTrue, bool& someFalse, Assignment* counterexample = nullptr) const;
+};
+
+/* All falsifying assignments of a proposition in the enumeration order of NaiveModelChecker.
+ * The assignments are evaluated 64 at once and decoded one at a time from the mask of the
+ * falsifying ones, so stopping early costs no further evaluation.
+ */
+class CounterexampleIterator {
+public:
+	CounterexampleIterator(const PropositionSP& proposition); // throws for more than 64 variables
+	~CounterexampleIterator() = default;
+
+	bool next(NaiveModelChecker::Assignment& counterexample); // false once all were returned
+
+private:
+	PropositionSP proposition;
+	std::vector<int> variableIds; // sorted
+	std::vector<uint64_t> varValues;
+	uint64_t blockCount; // of 64 assignments, the last one may be partial
+	uint64_t nextBlock;
+	uint64_t block; // the one being decoded
+	uint64_t falsified; // assignments of the block not returned yet, one bit each
 };
@@ -0,0 +1,207 @@
+#include "ModelCounter.hpp"
+
+#include "CnfSat.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+ModelCounter::ModelCounter(const Cnf& cnf) : clauses(cnf), variableCount(0), cacheHitCount(0) {
+	for (auto& clause : clauses)
+		for (auto& literal : clause)
+			squeezedIds[literal.varId] = 0;
+	for (auto& pair : squeezedIds)
+		pair.second = variableCount++;
+	for (auto& clause : clauses)
+		for (auto& literal : clause)
+			literal.varId = squeezedIds[literal.varId];
+	clauses.shrink_to_fit();
+}
+
+BigInteger ModelCounter::count() {
+	projected.assign(variableCount, true);
+	cache.clear();
+	cacheHitCount = 0;
+	return countFormula(clauses);
+}
+
+BigInteger ModelCounter::count(const std::vector<VariableId>& projection) {
+	projected.assign(variableCount, false);
+	cache.clear();
+	cacheHitCount = 0;
+	unsigned absentCount = 0; // projected variables which do not occur in the clauses
+	std::vector<VariableId> ids = projection;
+	std::sort(ids.begin(), ids.end());
+	ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+	for (auto id : ids) {
+		auto it = squeezedIds.find(id);
+		if (it != squeezedIds.end())
+			projected[it->second] = true;
+		else
+			absentCount++;
+	}
+	BigInteger result = countFormula(clauses);
+	return result << absentCount;
+}
+
+uint64_t ModelCounter::getCacheHitCount() const {
+	return cacheHitCount;
+}
+
+BigInteger ModelCounter::countPropModels(const PropositionSP& proposition) {
+	std::vector<int> variableIds;
+	proposition->getVariableIds(variableIds);
+	Cnf clauses;
+	propositionToCnf(clauses, proposition);
+	ModelCounter counter(clauses);
+	return counter.count(variableIds);
+}
+
+BigInteger ModelCounter::countFormula(Cnf formula) {
+	const int scopeCount = getProjectedCount(formula);
+	int assignedCount = 0;
+	bool anyUnit = true;
+	while (anyUnit) {
+		anyUnit = false;
+		for (auto& clause : formula) {
+			if (clause.empty())
+				return BigInteger(0);
+			if (clause.size() == 1) {
+				Literal unit = clause.front();
+				if (projected[unit.varId])
+					assignedCount++;
+				if (!assign(formula, unit))
+					return BigInteger(0);
+				anyUnit = true;
+				break;
+			}
+		}
+	}
+	const int freeCount = scopeCount - assignedCount - getProjectedCount(formula);
+	BigInteger result = BigInteger::powerOfTwo(freeCount);
+	if (formula.empty())
+		return result;
+
+	// connected components of the clause-variable graph
+	std::vector<int> parent(variableCount);
+	std::iota(parent.begin(), parent.end(), 0);
+	auto find = [&parent](int id) {
+		while (parent[id] != id)
+			id = parent[id] = parent[parent[id]];
+		return id;
+	};
+	for (auto& clause : formula)
+		for (size_t i = 1; i < clause.size(); i++)
+			parent[find(clause[i].varId)] = find(clause[0].varId);
+	std::map<int, Cnf> components;
+	for (auto& clause : formula)
+		components[find(clause.front().varId)].push_back(std::move(clause));
+
+	for (auto& component : components) {
+		result *= countComponent(component.second);
+		if (result.isZero())
+			break;
+	}
+	return result;
+}
+
+BigInteger ModelCounter::countComponent(const Cnf& component) {
+	std::string key = getCacheKey(component);
+	auto it = cache.find(key);
+	if (it != cache.end()) {
+		cacheHitCount++;
+		return it->second;
+	}
+
+	std::vector<int> occurrences(variableCount);
+	for (auto& clause : component)
+		for (auto& literal : clause)
+			occurrences[literal.varId]++;
+	VariableId branchId = -1;
+	for (VariableId id = 0; id < variableCount; id++)
+		if (projected[id] && occurrences[id] > 0 && (branchId == -1 || occurrences[id] > occurrences[branchId]))
+			branchId = id;
+
+	BigInteger result;
+	if (branchId == -1) {
+		// no projected variable left, only satisfiability matters
+		DpllCnfSat dpll(component);
+		result = BigInteger(dpll.isSatisfiable() ? 1 : 0);
+	}
+	else {
+		const int scopeCount = getProjectedCount(component);
+		for (int value = 0; value < 2; value++) {
+			Cnf formula = component;
+			if (!assign(formula, Literal(branchId, value == 0)))
+				continue;
+			const int freeCount = scopeCount - 1 - getProjectedCount(formula);
+			result += countFormula(formula) << freeCount;
+		}
+	}
+	cache.emplace(std::move(key), result);
+	return result;
+}
+
+bool ModelCounter::assign(Cnf& formula, Literal literal) const {
+	size_t newSize = 0;
+	for (size_t i = 0; i < formula.size(); i++) {
+		Clause& clause = formula[i];
+		bool satisfied = false;
+		size_t newClauseSize = 0;
+		for (size_t j = 0; j < clause.size(); j++) {
+			if (clause[j].varId == literal.varId) {
+				if (clause[j].neg == literal.neg) {
+					satisfied = true;
+					break;
+				}
+			}
+			else
+				clause[newClauseSize++] = clause[j];
+		}
+		if (satisfied)
+			continue;
+		if (newClauseSize == 0)
+			return false;
+		clause.erase(clause.begin() + newClauseSize, clause.end());
+		if (newSize != i)
+			formula[newSize] = std::move(clause);
+		newSize++;
+	}
+	formula.erase(formula.begin() + newSize, formula.end());
+	return true;
+}
+
+int ModelCounter::getProjectedCount(const Cnf& formula) const {
+	std::vector<bool> seen(variableCount);
+	int count = 0;
+	for (auto& clause : formula) {
+		for (auto& literal : clause) {
+			if (!seen[literal.varId]) {
+				seen[literal.varId] = true;
+				if (projected[literal.varId])
+					count++;
+			}
+		}
+	}
+	return count;
+}
+
+std::string ModelCounter::getCacheKey(const Cnf& component) const {
+	std::vector<std::vector<int>> codes;
+	for (auto& clause : component) {
+		std::vector<int> code;
+		for (auto& literal : clause)
+			code.push_back(literal.varId * 2 + (literal.neg ? 1 : 0));
+		std::sort(code.begin(), code.end());
+		codes.push_back(code);
+	}
+	std::sort(codes.begin(), codes.end());
+	std::string key;
+	for (auto& code : codes) {
+		// the literal count first, a separator byte could occur inside the codes
+		const int literalCount = static_cast<int>(code.size());
+		key.append(reinterpret_cast<const char*>(&literalCount), sizeof(literalCount));
+		for (int literalCode : code)
+			key.append(reinterpret_cast<const char*>(&literalCode), sizeof(literalCode));
+	}
+	return key;
+}
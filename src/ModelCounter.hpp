@@ -0,0 +1,38 @@
+#pragma once
+
+#include "NormalForm.hpp"
+#include "BigInteger.hpp"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+
+/* Exact model counting (#SAT) by DPLL-style branching with unit propagation,
+ * connected component decomposition and a cache of component counts keyed by
+ * the canonical clause list of the component.
+ */
+class ModelCounter {
+public:
+	ModelCounter(const Cnf& cnf);
+	~ModelCounter() = default;
+
+	BigInteger count(); // models over the variables occurring in the clauses
+	BigInteger count(const std::vector<VariableId>& projection); // models projected on the given variables
+	uint64_t getCacheHitCount() const;
+
+	static BigInteger countPropModels(const PropositionSP& proposition); // models over the proposition variables
+
+private:
+	Cnf clauses; // squeezed variable ids
+	int variableCount;
+	std::map<VariableId, VariableId> squeezedIds;
+	std::vector<bool> projected;
+	std::unordered_map<std::string, BigInteger> cache;
+	uint64_t cacheHitCount;
+
+	BigInteger countFormula(Cnf formula);
+	BigInteger countComponent(const Cnf& component);
+	bool assign(Cnf& formula, Literal literal) const; // false on conflict
+	int getProjectedCount(const Cnf& formula) const;
+	std::string getCacheKey(const Cnf& component) const;
+};
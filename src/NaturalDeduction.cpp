@@ -6,6 +6,7 @@
 #include <queue>
 
 const size_t MAX_UNPROC_SIZE = 50000000;
+const size_t ITEM_MEMORY_ESTIMATE = 256; // item, set node and the derived proposition nodes
 
 PropositionItem::PropositionItem(PropositionSP proposition, std::string infRuleName, int src1, int src2) :
 	proposition(proposition), infRuleName(infRuleName), src1(src1), src2(src2),
@@ -21,7 +22,7 @@ bool PropositionItem::operator<(const PropositionItem& rhs) const {
 
 int PropositionItem::idCounter = 0;
 
-NaturalDeduction::NaturalDeduction() : proofFound(false) {}
+NaturalDeduction::NaturalDeduction() : proofFound(false), budget(nullptr), budgetExceeded(false) {}
 
 void NaturalDeduction::addJasInferenceRules() {
 	Converter converter;
@@ -135,9 +136,19 @@ void NaturalDeduction::setConclusion(PropositionSP conclusion) {
 	proofFound = false;
 }
 
+void NaturalDeduction::setBudget(Budget* budget) {
+	this->budget = budget;
+	budgetExceeded = false;
+}
+
 bool NaturalDeduction::step() {
-	if (unprocPropositions.empty() || proofFound)
+	if (unprocPropositions.empty() || proofFound || budgetExceeded)
+		return false;
+	const size_t itemCount = procPropositions.size() + unprocPropositions.size();
+	if (budget && budget->isExceeded(1, itemCount * ITEM_MEMORY_ESTIMATE)) {
+		budgetExceeded = true;
 		return false;
+	}
 	auto unprocItem = *unprocPropositions.begin();
 	auto unprocProp = unprocItem.proposition;
 	auto unprocIndex = procPropositions.size();
@@ -177,6 +188,10 @@ bool NaturalDeduction::isProofFound() const {
 	return proofFound;
 }
 
+bool NaturalDeduction::isBudgetExceeded() const {
+	return budgetExceeded;
+}
+
 std::vector<PropositionItem> NaturalDeduction::getFullGraph() const {
 	std::vector<PropositionItem> fullGraph;
 	for (auto& item : procPropositions)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Proposition.hpp"
+#include "Budget.hpp"
 
 #include <vector>
 #include <string>
@@ -39,8 +40,10 @@ public:
 	void addPremise(PropositionSP premise);
 	void setConclusion(PropositionSP conclusion);
 
+	void setBudget(Budget* budget); // one call of step() is a step
 	bool step(); // continue as long as it returns true
 	bool isProofFound() const;
+	bool isBudgetExceeded() const; // true if step() stopped because of the budget
 
 	std::vector<PropositionItem> getFullGraph() const;
 	std::vector<PropositionItem> getProofGraph(PropositionSP conclusion = nullptr) const;
@@ -54,6 +57,8 @@ protected:
 	std::set<PropositionItem> unprocPropositions;
 	PropositionSP conclusion;
 	bool proofFound;
+	Budget* budget;
+	bool budgetExceeded;
 
 	void addProposition(PropositionItem item);
 	inline PropositionSP applyRule(const InferenceRule& rule, PropositionSP prop) const;
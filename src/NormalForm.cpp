@@ -7,6 +7,9 @@
 
 #include <cassert>
 #include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <iterator>
 
 bool traverseLiteral(std::vector<Literal>& literals, const PropositionSP& literal, bool negation) {
 	if (literal->getType() == Proposition::UNARY &&
@@ -95,6 +98,111 @@ void propositionToCnf(Cnf& clauses, PropositionSP proposition) {
 	clauses.shrink_to_fit();
 }
 
+struct TseitinEncoder {
+	Cnf& clauses;
+	VariableId nextId;
+	VariableId trueId; // -1 until a constant occurs
+	std::unordered_map<const Proposition*, Literal> literals; // shared subtrees are encoded once
+
+	TseitinEncoder(Cnf& clauses, VariableId nextId) : clauses(clauses), nextId(nextId), trueId(-1) {}
+
+	Literal getConstant(bool value) {
+		if (trueId == -1) {
+			trueId = nextId++;
+			clauses.push_back({ Literal(trueId, false) });
+		}
+		return Literal(trueId, !value);
+	}
+
+	Literal encode(const PropositionSP& proposition) {
+		auto it = literals.find(proposition.get());
+		if (it != literals.end())
+			return it->second;
+		const Literal result = encodeNew(proposition);
+		literals.emplace(proposition.get(), result);
+		return result;
+	}
+
+	Literal encodeNew(const PropositionSP& proposition) {
+		switch (proposition->getType()) {
+		case Proposition::VARIABLE:
+			return Literal(std::static_pointer_cast<Variable>(proposition)->getId(), false);
+		case Proposition::CONSTANT:
+			return getConstant(std::static_pointer_cast<Constant>(proposition)->getValue() == Constant::TRUE);
+		case Proposition::UNARY: {
+			auto unary = std::static_pointer_cast<UnaryOperator>(proposition);
+			if (unary->getOp() == UnaryOperator::FALSE || unary->getOp() == UnaryOperator::TRUE)
+				return getConstant(unary->getOp() == UnaryOperator::TRUE);
+			const Literal operand = encode(unary->getOperand());
+			return unary->getOp() == UnaryOperator::NOT ? Literal(operand.varId, !operand.neg) : operand;
+		}
+		case Proposition::BINARY:
+			return encodeBinary(std::static_pointer_cast<BinaryOperator>(proposition));
+		}
+		assert(!"Unexpected proposition");
+		return getConstant(false);
+	}
+
+	Literal encodeBinary(const std::shared_ptr<BinaryOperator>& binary) {
+		const int op = binary->getOp();
+		// the bits of op from the highest are the values for (0, 0), (0, 1), (1, 0), (1, 1)
+		auto value = [op](int left, int right) { return ((op >> (3 - left * 2 - right)) & 1) != 0; };
+		switch (binary->getOp()) {
+		case BinaryOperator::FALSE:
+		case BinaryOperator::TRUE:
+			return getConstant(binary->getOp() == BinaryOperator::TRUE);
+		case BinaryOperator::A:
+		case BinaryOperator::NA: {
+			const Literal left = encode(binary->getLeft());
+			return Literal(left.varId, left.neg != (binary->getOp() == BinaryOperator::NA));
+		}
+		case BinaryOperator::B:
+		case BinaryOperator::NB: {
+			const Literal right = encode(binary->getRight());
+			return Literal(right.varId, right.neg != (binary->getOp() == BinaryOperator::NB));
+		}
+		default:
+			break;
+		}
+		const Literal inputs[2] = { encode(binary->getLeft()), encode(binary->getRight()) };
+		const VariableId output = nextId++;
+		// a clause per row of the truth table: some input differs from the row or the output has its value,
+		// two rows which differ in one input only and agree on the value share a binary clause
+		auto differs = [&inputs](int input, int inputValue) {
+			return Literal(inputs[input].varId, inputs[input].neg != (inputValue != 0));
+		};
+		bool covered[2][2] = {};
+		for (int input = 0; input < 2; input++)
+			for (int inputValue = 0; inputValue < 2; inputValue++) {
+				const int row0[2] = { input == 0 ? inputValue : 0, input == 1 ? inputValue : 0 };
+				const int row1[2] = { input == 0 ? inputValue : 1, input == 1 ? inputValue : 1 };
+				const bool rowValue = value(row0[0], row0[1]);
+				if (rowValue != value(row1[0], row1[1]) ||
+					(covered[row0[0]][row0[1]] && covered[row1[0]][row1[1]]))
+					continue;
+				clauses.push_back({ differs(input, inputValue), Literal(output, !rowValue) });
+				covered[row0[0]][row0[1]] = covered[row1[0]][row1[1]] = true;
+			}
+		for (int left = 0; left < 2; left++)
+			for (int right = 0; right < 2; right++)
+				if (!covered[left][right])
+					clauses.push_back({ differs(0, left), differs(1, right), Literal(output, !value(left, right)) });
+		return Literal(output, false);
+	}
+};
+
+Literal propositionToTseitinCnf(Cnf& clauses, const PropositionSP& proposition) {
+	std::vector<int> variableIds;
+	proposition->getVariableIds(variableIds);
+	VariableId nextId = 0;
+	for (int id : variableIds)
+		nextId = std::max(nextId, id + 1);
+	TseitinEncoder encoder(clauses, nextId);
+	const Literal result = encoder.encode(proposition);
+	removeRedundancy(clauses); // an operator over the same variable twice
+	return result;
+}
+
 PropositionSP clauseToProposition(const Clause& clause) {
 	if (clause.empty())
 		return std::make_shared<Constant>(Constant::FALSE);
@@ -159,6 +267,35 @@ void generateCnf(Cnf& clauses, int literalNum, int clauseNum, int variableNum) {
 	generateCnf(clauses, literalNum, clauseNum, variableNum, gen);
 }
 
+void generatePlantedCnf(Cnf& clauses, std::vector<bool>& model, int literalNum, int clauseNum,
+                        int variableNum, std::mt19937& gen) {
+	assert(literalNum <= variableNum);
+	std::uniform_int_distribution<> varDist(0, variableNum - 1);
+	std::uniform_int_distribution<> boolDist(0, 1);
+	model.resize(variableNum);
+	for (int i = 0; i < variableNum; i++)
+		model[i] = boolDist(gen) != 0;
+	clauses.clear();
+	while (clauses.size() < clauseNum) {
+		Clause clause;
+		bool satisfied = false;
+		while (clause.size() < literalNum) {
+			VariableId id = varDist(gen);
+			bool exists = false;
+			for (auto& literal : clause)
+				if (literal.varId == id)
+					exists = true;
+			if (exists)
+				continue;
+			Literal literal(id, boolDist(gen) != 0);
+			satisfied = satisfied || model[id] != literal.neg;
+			clause.push_back(literal);
+		}
+		if (satisfied)
+			clauses.push_back(clause);
+	}
+}
+
 void squeezeVariableIds(Cnf& clauses) {
 	std::map<VariableId, VariableId> map;
 	for (auto& clause : clauses)
@@ -173,3 +310,30 @@ void squeezeVariableIds(Cnf& clauses) {
 		for (auto& literal : clause)
 			literal.varId = map[literal.varId];
 }
+
+void squeezeVariableIds(Cnf& clauses, std::vector<VariableId>& originalIds, size_t firstNewClause) {
+	std::vector<VariableId> newIds;
+	for (size_t i = firstNewClause; i < clauses.size(); i++)
+		for (auto& literal : clauses[i])
+			if (!std::binary_search(originalIds.begin(), originalIds.end(), literal.varId))
+				newIds.push_back(literal.varId);
+	if (!newIds.empty()) {
+		std::sort(newIds.begin(), newIds.end());
+		newIds.erase(std::unique(newIds.begin(), newIds.end()), newIds.end());
+		std::vector<VariableId> mergedIds;
+		std::merge(originalIds.begin(), originalIds.end(), newIds.begin(), newIds.end(),
+			       std::back_inserter(mergedIds));
+		std::vector<VariableId> renumbering(originalIds.size());
+		for (size_t id = 0; id < originalIds.size(); id++)
+			renumbering[id] = static_cast<VariableId>(std::lower_bound(mergedIds.begin(),
+				mergedIds.end(), originalIds[id]) - mergedIds.begin());
+		for (size_t i = 0; i < firstNewClause; i++)
+			for (auto& literal : clauses[i])
+				literal.varId = renumbering[literal.varId];
+		originalIds = std::move(mergedIds);
+	}
+	for (size_t i = firstNewClause; i < clauses.size(); i++)
+		for (auto& literal : clauses[i])
+			literal.varId = static_cast<VariableId>(std::lower_bound(originalIds.begin(),
+				originalIds.end(), literal.varId) - originalIds.begin());
+}
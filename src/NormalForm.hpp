@@ -19,6 +19,9 @@ using Clause = std::vector<Literal>;
 using Cnf = std::vector<Clause>;
 
 void propositionToCnf(Cnf& clauses, PropositionSP proposition);
+// Definitional (Tseitin) CNF, linear in the proposition size: the returned literal is equivalent to
+// the proposition in every model of the clauses, the new variables get ids above those of the proposition
+Literal propositionToTseitinCnf(Cnf& clauses, const PropositionSP& proposition);
 PropositionSP clauseToProposition(const Clause& clause);
 PropositionSP cnfToProposition(const Cnf& clauses);
 
@@ -26,5 +29,11 @@ void generateClause(Clause& clause, int literalNum, int variableNum);
 void generateCnf(Cnf& clauses, int literalNum, int clauseNum, int variableNum);
 void generateClause(Clause& clause, int literalNum, int variableNum, std::mt19937& gen);
 void generateCnf(Cnf& clauses, int literalNum, int clauseNum, int variableNum, std::mt19937& gen);
+// Satisfiable by the random model: clauses of distinct variables falsified by it are rejected
+void generatePlantedCnf(Cnf& clauses, std::vector<bool>& model, int literalNum, int clauseNum,
+                        int variableNum, std::mt19937& gen);
 
 void squeezeVariableIds(Cnf& clauses);
+// Clauses before firstNewClause are squeezed according to originalIds (squeezed id -> original id),
+// the rest has original ids. All clauses end up squeezed in increasing order of the original ids.
+void squeezeVariableIds(Cnf& clauses, std::vector<VariableId>& originalIds, size_t firstNewClause);
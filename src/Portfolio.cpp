@@ -0,0 +1,195 @@
+#include "Portfolio.hpp"
+
+#include "CnfSat.hpp"
+#include "Resolution.hpp"
+#include "UnaryOperator.hpp"
+#include "ThreadPool.hpp"
+
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+
+namespace {
+
+struct Race {
+	Budget budget; // stopped by the first answer
+	std::mutex mutex;
+	std::condition_variable finished;
+	int runningCount;
+	bool answered;
+	bool satisfiable;
+	std::string winner;
+	std::vector<bool> model;
+
+	Race(int engineCount, Budget* parent) : budget(parent), runningCount(engineCount),
+		                                    answered(false), satisfiable(false) {}
+
+	void answer(const std::string& engine, bool satisfiable, const std::vector<bool>& model) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (answered)
+			return;
+		answered = true;
+		this->satisfiable = satisfiable;
+		this->winner = engine;
+		this->model = model;
+		budget.stop();
+	}
+
+	void engineFinished() {
+		std::lock_guard<std::mutex> lock(mutex);
+		runningCount--;
+		finished.notify_all();
+	}
+};
+
+struct Engine {
+	std::string name;
+	std::function<void(Race&, const std::string&)> run;
+};
+
+} // namespace
+
+PortfolioSat::PortfolioSat(const Cnf& cnf, unsigned threadCount) :
+	clauses(cnf), threadCount(threadCount), variableCount(0), budget(nullptr), interrupted(false) {
+	squeezeVariableIds(clauses);
+	clauses.shrink_to_fit();
+	for (auto& clause : clauses)
+		for (auto& literal : clause)
+			variableCount = std::max(literal.varId + 1, variableCount);
+}
+
+void PortfolioSat::setBudget(Budget* budget) {
+	this->budget = budget;
+}
+
+bool PortfolioSat::isSatisfiable() {
+	const int WALKSAT_COUNT = 3;
+
+	std::vector<Engine> engines;
+	auto addDpll = [&](const std::string& name, DpllCnfSat::Branching branching, bool firstValue) {
+		engines.push_back({ name, [this, branching, firstValue](Race& race, const std::string& name) {
+			DpllCnfSat dpll(clauses);
+			dpll.setBranching(branching, firstValue);
+			dpll.setBudget(&race.budget);
+			bool result = dpll.isSatisfiable();
+			if (!dpll.isInterrupted())
+				race.answer(name, result, result ? dpll.getModel() : std::vector<bool>());
+		} });
+	};
+	addDpll("DPLL", DpllCnfSat::FIRST_UNASSIGNED, false);
+	addDpll("DPLL (true first)", DpllCnfSat::FIRST_UNASSIGNED, true);
+	addDpll("DPLL (most occurrences)", DpllCnfSat::MOST_OCCURRENCES, false);
+	for (int i = 0; i < WALKSAT_COUNT; i++) {
+		engines.push_back({ "WalkSAT #" + std::to_string(i + 1), [this](Race& race, const std::string& name) {
+			WalkSat walkSat(clauses);
+			walkSat.setBudget(&race.budget);
+			if (walkSat.isSatisfiable(std::numeric_limits<uint64_t>::max()))
+				race.answer(name, true, walkSat.getModel());
+		} }); // WalkSAT cannot prove unsatisfiability
+	}
+	if (variableCount <= Resolution::MAX_VARIABLE_COUNT) {
+		engines.push_back({ "Resolution", [this](Race& race, const std::string& name) {
+			bool interrupted = false;
+			bool contradiction = Resolution::isCnfContradiction(clauses, &race.budget, &interrupted);
+			if (!interrupted)
+				race.answer(name, !contradiction, std::vector<bool>());
+		} });
+	}
+
+	Race race(static_cast<int>(engines.size()), budget);
+	{
+		ThreadPool pool(threadCount > 0 ? threadCount : static_cast<unsigned>(engines.size()));
+		for (auto& engine : engines) {
+			pool.submit([&race, &engine] {
+				if (!race.budget.isStopped())
+					engine.run(race, engine.name);
+				race.engineFinished();
+			});
+		}
+		{
+			std::unique_lock<std::mutex> lock(race.mutex);
+			race.finished.wait(lock, [&race] { return race.answered || race.runningCount == 0; });
+		}
+		race.budget.stop();
+		pool.wait();
+	}
+
+	interrupted = !race.answered;
+	winner = race.winner;
+	model = race.model;
+	return race.satisfiable;
+}
+
+bool PortfolioSat::isInterrupted() const {
+	return interrupted;
+}
+
+std::string PortfolioSat::getWinner() const {
+	return winner;
+}
+
+std::vector<bool> PortfolioSat::getModel() const {
+	return model;
+}
+
+bool PortfolioSat::isPropValid(const PropositionSP& proposition, std::string* winner) {
+	auto notProposition = std::make_shared<UnaryOperator>(proposition, UnaryOperator::NOT);
+	return isPropContradiction(notProposition, winner);
+}
+
+bool PortfolioSat::isPropContradiction(const PropositionSP& proposition, std::string* winner) {
+	Cnf clauses;
+	propositionToCnf(clauses, proposition);
+	PortfolioSat portfolio(clauses);
+	bool result = !portfolio.isSatisfiable();
+	if (winner)
+		*winner = portfolio.getWinner();
+	return result;
+}
+
+
+Budget::Answer PortfolioSat::isPropValid(const PropositionSP& proposition, Budget& budget, std::string* winner) {
+	auto notProposition = std::make_shared<UnaryOperator>(proposition, UnaryOperator::NOT);
+	return isPropContradiction(notProposition, budget, winner);
+}
+
+Budget::Answer PortfolioSat::isPropContradiction(const PropositionSP& proposition, Budget& budget,
+	                                             std::string* winner) {
+	Cnf clauses;
+	propositionToCnf(clauses, proposition);
+	PortfolioSat portfolio(clauses);
+	portfolio.setBudget(&budget);
+	bool result = !portfolio.isSatisfiable();
+	if (winner)
+		*winner = portfolio.getWinner();
+	if (portfolio.isInterrupted())
+		return Budget::UNKNOWN;
+	return Budget::toAnswer(result);
+}
+
+Proposition::Validity PortfolioSat::classifyProp(const PropositionSP& proposition, std::string* winner) {
+	Budget budget;
+	return classifyProp(proposition, budget, winner);
+}
+
+Proposition::Validity PortfolioSat::classifyProp(const PropositionSP& proposition, Budget& budget,
+	                                             std::string* winner) {
+	Cnf clauses;
+	const Literal output = propositionToTseitinCnf(clauses, proposition);
+	bool results[2]; // satisfiable with the output true, with the output false
+	for (int i = 0; i < 2; i++) {
+		Cnf assumed = clauses;
+		assumed.push_back({ Literal(output.varId, output.neg != (i == 1)) });
+		PortfolioSat portfolio(assumed);
+		portfolio.setBudget(&budget);
+		results[i] = portfolio.isSatisfiable();
+		if (winner)
+			*winner = portfolio.getWinner();
+		if (portfolio.isInterrupted())
+			return Proposition::UNDECIDED;
+		if (!results[0])
+			return Proposition::CONTRADICTION;
+	}
+	return results[1] ? Proposition::CONTINGENT : Proposition::VALID;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "NormalForm.hpp"
+#include "Budget.hpp"
+
+#include <string>
+
+/* Races several differently configured SAT engines on a thread pool:
+ * DPLL variants, WalkSAT walkers and (for at most 64 variables) Resolution.
+ * The first definitive answer wins and the remaining engines are stopped.
+ */
+class PortfolioSat {
+public:
+	PortfolioSat(const Cnf& cnf, unsigned threadCount = 0); // 0 means one thread per engine
+	~PortfolioSat() = default;
+
+	void setBudget(Budget* budget); // shared by all engines
+	bool isSatisfiable();
+	bool isInterrupted() const; // true if the budget was exceeded before any engine answered
+	std::string getWinner() const; // name of the engine which gave the answer
+	std::vector<bool> getModel() const; // squeezed variable ids, empty if the winner gives no model
+
+	static bool isPropValid(const PropositionSP& proposition, std::string* winner = nullptr);
+	static bool isPropContradiction(const PropositionSP& proposition, std::string* winner = nullptr);
+	static Budget::Answer isPropValid(const PropositionSP& proposition, Budget& budget,
+		                              std::string* winner = nullptr);
+	static Budget::Answer isPropContradiction(const PropositionSP& proposition, Budget& budget,
+		                                      std::string* winner = nullptr);
+	// One Tseitin encoding raced twice, with the output literal and with its negation as a unit clause;
+	// the winner is that of the last race
+	static Proposition::Validity classifyProp(const PropositionSP& proposition, std::string* winner = nullptr);
+	static Proposition::Validity classifyProp(const PropositionSP& proposition, Budget& budget,
+		                                      std::string* winner = nullptr);
+
+private:
+	Cnf clauses;
+	unsigned threadCount;
+	int variableCount;
+	Budget* budget;
+	bool interrupted;
+	std::string winner;
+	std::vector<bool> model;
+};
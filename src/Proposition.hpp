@@ -10,6 +10,7 @@ public:
     virtual ~Proposition() = default;
 
     enum Type {VARIABLE, CONSTANT, UNARY, BINARY};
+    enum Validity {VALID, CONTRADICTION, CONTINGENT, UNDECIDED}; // UNDECIDED if a budget was exceeded
     virtual Type getType() const = 0;
 
     virtual bool isEquivalent(std::shared_ptr<Proposition> proposition) const = 0;
@@ -6,40 +6,98 @@
 #include "BinaryOperator.hpp"
 #include "NormalForm.hpp"
 #include "Converter.hpp"
+#include "ThreadPool.hpp"
+#include "CnfSat.hpp"
+#include "Zbdd.hpp"
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
 #include <string>
-//#include <iostream>
-#include <unordered_set>
-#include <unordered_map>
-#include <set>
+#include <map>
+#include <memory>
+#include <functional>
+#include <sstream>
 #include <chrono>
-//#include <bit>
+#include <bit>
+#include <stdexcept>
 
 // TODO: This module requires refactoring (after optimizations?)!
 
-const bool RECORD_GRAPH = true;
+// Accumulates the time between the calls of stop into the given phases, a no-op when disabled
+class PhaseTimer {
+public:
+	PhaseTimer(bool enabled) : enabled(enabled) {
+		if (enabled)
+			start = std::chrono::high_resolution_clock::now();
+	}
+
+	void stop(std::chrono::nanoseconds& phaseTime) {
+		if (!enabled)
+			return;
+		auto end = std::chrono::high_resolution_clock::now();
+		phaseTime += end - start;
+		start = end;
+	}
 
-//size_t p_iter = 0;
-//size_t p_prod = 0;
-//size_t p_current = 0;
-//size_t p_exists = 0;
-//size_t p_removetest = 0;
-//size_t p_proc = 0;
-//size_t p_add = 0;
-//size_t p_remove = 0;
+private:
+	bool enabled;
+	std::chrono::high_resolution_clock::time_point start;
+};
 
+// Clause over W 64-bit words of variables, the kernels are unrolled for each width
+template<int W>
 struct BitClause {
-	static const int VARIABLE_COUNT = sizeof(uint64_t) * 8;
-	uint64_t pLiterals;
-	uint64_t nLiterals;
+	static const int VARIABLE_COUNT = W * 64;
+	uint64_t pLiterals[W];
+	uint64_t nLiterals[W];
+
+	BitClause() {
+		for (int i = 0; i < W; i++)
+			pLiterals[i] = nLiterals[i] = 0;
+	}
+
+	static uint64_t getMask(int v) {
+		return static_cast<uint64_t>(1) << (v % 64);
+	}
 
-	BitClause() : pLiterals(0), nLiterals(0) {}
+	bool isPositive(int v) const {
+		return (pLiterals[v / 64] & getMask(v)) != 0;
+	}
+
+	void addLiteral(int v, bool neg) {
+		(neg ? nLiterals : pLiterals)[v / 64] |= getMask(v);
+	}
+
+	void removeLiteral(int v, bool neg) {
+		(neg ? nLiterals : pLiterals)[v / 64] &= ~getMask(v);
+	}
+
+	// Variables are visited in increasing order, f returns true to stop
+	template<typename F>
+	bool forEachVariable(F f) const {
+		for (int i = 0; i < W; i++) {
+			for (uint64_t bits = pLiterals[i] | nLiterals[i]; bits; bits &= bits - 1)
+				if (f(i * 64 + std::countr_zero(bits)))
+					return true;
+		}
+		return false;
+	}
+
+	BitClause operator|(const BitClause& rhs) const {
+		BitClause result;
+		for (int i = 0; i < W; i++) {
+			result.pLiterals[i] = pLiterals[i] | rhs.pLiterals[i];
+			result.nLiterals[i] = nLiterals[i] | rhs.nLiterals[i];
+		}
+		return result;
+	}
 
 	bool operator==(const BitClause& rhs) const {
-		return pLiterals == rhs.pLiterals &&
-			nLiterals == rhs.nLiterals;
+		for (int i = 0; i < W; i++)
+			if (pLiterals[i] != rhs.pLiterals[i] || nLiterals[i] != rhs.nLiterals[i])
+				return false;
+		return true;
 	}
 
 	bool operator!=(const BitClause& rhs) const {
@@ -47,151 +105,285 @@ struct BitClause {
 	}
 
 	bool operator<(const BitClause& rhs) const {
-		/*auto popcount = [](uint64_t x) {
-			const uint64_t m1 = 0x5555555555555555;
-			const uint64_t m4 = 0x0f0f0f0f0f0f0f0f;
-			const uint64_t h01 = 0x0101010101010101;
-			const uint64_t m2 = 0x3333333333333333;
-			x -= (x >> 1) & m1;
-			x = (x & m2) + ((x >> 2) & m2);
-			x = (x + (x >> 4)) & m4;
-			return (x * h01) >> 56;
-			};
-		int oneCount = popcount(pLiterals | nLiterals);
-		int rhsOneCount = popcount(rhs.pLiterals | rhs.nLiterals);
-		assert(std::popcount(pLiterals | nLiterals) == oneCount);
-		assert(std::popcount(rhs.pLiterals | rhs.nLiterals) == rhsOneCount);
-		if (oneCount != rhsOneCount)
-			return oneCount < rhsOneCount;*/
-		uint64_t literalsLhs = pLiterals | nLiterals;
-		uint64_t literalsRhs = rhs.pLiterals | rhs.nLiterals;
-		if(literalsLhs != literalsRhs)
-			return literalsLhs < literalsRhs;
-		return pLiterals < rhs.pLiterals;
-		/*if (pLiterals != rhs.pLiterals)
-			return pLiterals < rhs.pLiterals;
-		return nLiterals < rhs.nLiterals;*/
+		// the most significant word first
+		for (int i = W - 1; i >= 0; i--) {
+			uint64_t literalsLhs = pLiterals[i] | nLiterals[i];
+			uint64_t literalsRhs = rhs.pLiterals[i] | rhs.nLiterals[i];
+			if (literalsLhs != literalsRhs)
+				return literalsLhs < literalsRhs;
+		}
+		for (int i = W - 1; i >= 0; i--)
+			if (pLiterals[i] != rhs.pLiterals[i])
+				return pLiterals[i] < rhs.pLiterals[i];
+		return false;
 	}
 
 	bool empty() const {
-		return (pLiterals | nLiterals) == 0;
+		uint64_t literals = 0;
+		for (int i = 0; i < W; i++)
+			literals |= pLiterals[i] | nLiterals[i];
+		return literals == 0;
+	}
+
+	int size() const {
+		int literalCount = 0;
+		for (int i = 0; i < W; i++)
+			literalCount += std::popcount(pLiterals[i] | nLiterals[i]);
+		return literalCount;
+	}
+
+	bool hasLiterals(bool neg) const {
+		uint64_t literals = 0;
+		for (int i = 0; i < W; i++)
+			literals |= neg ? nLiterals[i] : pLiterals[i];
+		return literals != 0;
+	}
+
+	int getMaxVariable() const { // -1 if empty
+		for (int i = W - 1; i >= 0; i--) {
+			uint64_t literals = pLiterals[i] | nLiterals[i];
+			if (literals)
+				return i * 64 + 63 - std::countl_zero(literals);
+		}
+		return -1;
+	}
+
+	bool isTautology() const {
+		uint64_t common = 0;
+		for (int i = 0; i < W; i++)
+			common |= pLiterals[i] & nLiterals[i];
+		return common != 0;
 	}
 
 	bool isSubset(const BitClause& rhs) const {
-		return (pLiterals & ~rhs.pLiterals) == 0 &&
-			(nLiterals & ~rhs.nLiterals) == 0;
+		uint64_t rest = 0;
+		for (int i = 0; i < W; i++)
+			rest |= (pLiterals[i] & ~rhs.pLiterals[i]) | (nLiterals[i] & ~rhs.nLiterals[i]);
+		return rest == 0;
 	}
 
 	bool isProperSubset(const BitClause& rhs) const {
 		return isSubset(rhs) && *this != rhs;
 	}
+
+	BitClause getCommon(const BitClause& rhs) const {
+		BitClause result;
+		for (int i = 0; i < W; i++) {
+			result.pLiterals[i] = pLiterals[i] & rhs.pLiterals[i];
+			result.nLiterals[i] = nLiterals[i] & rhs.nLiterals[i];
+		}
+		return result;
+	}
+
+	// literals whose complements are in rhs
+	BitClause getComplementary(const BitClause& rhs) const {
+		BitClause result;
+		for (int i = 0; i < W; i++) {
+			result.pLiterals[i] = pLiterals[i] & rhs.nLiterals[i];
+			result.nLiterals[i] = nLiterals[i] & rhs.pLiterals[i];
+		}
+		return result;
+	}
+
+	// literals without their complements
+	BitClause getPure() const {
+		BitClause result;
+		for (int i = 0; i < W; i++) {
+			result.pLiterals[i] = pLiterals[i] & ~nLiterals[i];
+			result.nLiterals[i] = nLiterals[i] & ~pLiterals[i];
+		}
+		return result;
+	}
 };
 
-namespace std {
-    template<>
-    struct hash<BitClause> {
-        size_t operator()(const BitClause& bc) const {
-            return mix(bc.pLiterals, bc.nLiterals);
-        }
-
-    private:
-        size_t mix(uint64_t a, uint64_t b) const {
-            size_t hashA = simpleHash(a);
-            size_t hashB = simpleHash(b);
-            return hashA ^ (hashB + 0x9e3779b9 + (hashA << 6) + (hashA >> 2));
-        }
-
-        size_t simpleHash(uint64_t x) const {
-			x ^= rotateLeft(x, 33);
-            x *= 0xff51afd7ed558ccd;
-            x ^= rotateLeft(x, 47);
-            return static_cast<size_t>(x);
-        }
-
-        uint64_t rotateLeft(uint64_t x, int r) const {
-            return (x << r) | (x >> (64 - r));
-        }
-    };
-}
-
-struct BucketBuff {
-	std::vector<std::unordered_set<BitClause>> pBuckets;
-	std::vector<std::unordered_set<BitClause>> nBuckets;
-
-	BucketBuff() : pBuckets(BitClause::VARIABLE_COUNT),
-		           nBuckets(BitClause::VARIABLE_COUNT) {}
-
-	void addClause(BitClause clause) {
-		assert(pBuckets.size() == BitClause::VARIABLE_COUNT);
-		assert(nBuckets.size() == BitClause::VARIABLE_COUNT);
-		for (int v = 0; v < BitClause::VARIABLE_COUNT; v++) {
-			uint64_t mask = static_cast<uint64_t>(1) << v;
-			if (clause.pLiterals & mask) {
-				//p_add++;
-				BitClause newClause = clause;
-				newClause.pLiterals &= ~mask;
-				pBuckets[v].insert(newClause);
-			}
-			if (clause.nLiterals & mask) {
-				//p_add++;
-				BitClause newClause = clause;
-				newClause.nLiterals &= ~mask;
-				nBuckets[v].insert(newClause);
-			}
+// Processed clauses stored in one array and indexed by literal (2 * variable + negative) in flat
+// lists of clause indexes. Resolvents are generated from the occurrence lists of the complementary
+// literals, forward subsumption scans the clauses whose smallest literal occurs in the tested clause
+// and backward subsumption the occurrence list of its rarest literal. Removed clauses leave the
+// occurrence lists lazily, all lists are compacted once the removed clauses outnumber the rest.
+// With unit tracking the literals of the unit clauses are kept in one mask for strengthening.
+template<int W>
+struct ClauseIndex {
+	std::vector<BitClause<W>> clauses;
+	std::vector<int> recordIds; // -1 without proof recording
+	std::vector<int> goalDistances;
+	std::vector<bool> removed;
+	std::vector<std::vector<int>> minLiteralLists;
+	std::vector<std::vector<int>> occurrences;
+	std::vector<int> literalCounts; // of the clauses not removed
+	size_t clauseCount;
+	bool unitTracking;
+	BitClause<W> units; // a unit is never removed, only the empty clause would subsume it
+	std::vector<int> unitRecordIds; // by literal
+	std::vector<int> unitGoalDistances;
+
+	ClauseIndex(int variableCount, bool unitTracking) : minLiteralLists(variableCount * 2),
+		                                                occurrences(variableCount * 2),
+		                                                literalCounts(variableCount * 2), clauseCount(0),
+		                                                unitTracking(unitTracking),
+		                                                unitRecordIds(unitTracking ? variableCount * 2 : 0),
+		                                                unitGoalDistances(unitTracking ? variableCount * 2 : 0) {}
+
+	static int getLiteral(const BitClause<W>& clause, int v) {
+		return v * 2 + (clause.isPositive(v) ? 0 : 1);
+	}
+
+	size_t size() const {
+		return clauseCount;
+	}
+
+	void add(const BitClause<W>& clause, int recordId, int goalDistance) {
+		const int index = static_cast<int>(clauses.size());
+		bool first = true;
+		clause.forEachVariable([&](int v) {
+			const int literal = getLiteral(clause, v);
+			if (first)
+				minLiteralLists[literal].push_back(index);
+			first = false;
+			occurrences[literal].push_back(index);
+			literalCounts[literal]++;
+			return false;
+		});
+		clauses.push_back(clause);
+		recordIds.push_back(recordId);
+		goalDistances.push_back(goalDistance);
+		removed.push_back(false);
+		clauseCount++;
+		if (unitTracking && clause.size() == 1) {
+			const int v = clause.getMaxVariable();
+			const int literal = getLiteral(clause, v);
+			units.addLiteral(v, !clause.isPositive(v));
+			unitRecordIds[literal] = recordId;
+			unitGoalDistances[literal] = goalDistance;
 		}
 	}
 
-	void removeClause(BitClause clause) {
-		assert(pBuckets.size() == BitClause::VARIABLE_COUNT);
-		assert(nBuckets.size() == BitClause::VARIABLE_COUNT);
-		for (int v = 0; v < BitClause::VARIABLE_COUNT; v++) {
-			uint64_t mask = static_cast<uint64_t>(1) << v;
-			if (clause.pLiterals & mask) {
-				//p_remove++;
-				BitClause removedClause = clause;
-				removedClause.pLiterals &= ~mask;
-				pBuckets[v].erase(removedClause);
+	// true if a processed clause is a subset of the clause
+	bool isSubsumed(const BitClause<W>& clause) const {
+		return clause.forEachVariable([&](int v) {
+			for (int index : minLiteralLists[getLiteral(clause, v)])
+				if (clauses[index].isSubset(clause))
+					return true;
+			return false;
+		});
+	}
+
+	// removes the processed clauses which are proper supersets of the clause, returns their number
+	size_t removeSubsumed(const BitClause<W>& clause) {
+		int rarestLiteral = -1;
+		clause.forEachVariable([&](int v) {
+			const int literal = getLiteral(clause, v);
+			if (rarestLiteral == -1 || occurrences[literal].size() < occurrences[rarestLiteral].size())
+				rarestLiteral = literal;
+			return false;
+		});
+		if (rarestLiteral == -1)
+			return 0;
+		auto& list = occurrences[rarestLiteral];
+		const size_t oldClauseCount = clauseCount;
+		size_t kept = 0;
+		for (size_t i = 0; i < list.size(); i++) {
+			const int index = list[i];
+			if (removed[index])
+				continue;
+			if (clause.isProperSubset(clauses[index])) {
+				remove(index);
+				continue;
 			}
-			if (clause.nLiterals & mask) {
-				//p_remove++;
-				BitClause removedClause = clause;
-				removedClause.nLiterals &= ~mask;
-				nBuckets[v].erase(removedClause);
+			list[kept++] = index;
+		}
+		list.resize(kept);
+		const size_t removedCount = oldClauseCount - clauseCount;
+		if (clauses.size() > clauseCount * 2)
+			compact();
+		return removedCount;
+	}
+
+	void remove(int index) {
+		removed[index] = true;
+		clauseCount--;
+		const auto& clause = clauses[index];
+		clause.forEachVariable([&](int v) {
+			literalCounts[getLiteral(clause, v)]--;
+			return false;
+		});
+		clause.forEachVariable([&](int v) {
+			auto& list = minLiteralLists[getLiteral(clause, v)];
+			for (size_t i = 0; i < list.size(); i++) {
+				if (list[i] == index) {
+					list[i] = list.back();
+					list.pop_back();
+					break;
+				}
 			}
+			return true; // only the smallest literal
+		});
+	}
+
+	// drops the removed clauses and renumbers the rest
+	void compact() {
+		std::vector<int> newIndexes(clauses.size(), -1);
+		size_t kept = 0;
+		for (size_t i = 0; i < clauses.size(); i++) {
+			if (removed[i])
+				continue;
+			newIndexes[i] = static_cast<int>(kept);
+			recordIds[kept] = recordIds[i];
+			goalDistances[kept] = goalDistances[i];
+			clauses[kept++] = clauses[i];
 		}
+		clauses.resize(kept);
+		recordIds.resize(kept);
+		goalDistances.resize(kept);
+		removed.assign(kept, false);
+		auto renumber = [&newIndexes](std::vector<int>& list) {
+			size_t listKept = 0;
+			for (int index : list)
+				if (newIndexes[index] != -1)
+					list[listKept++] = newIndexes[index];
+			list.resize(listKept);
+		};
+		for (auto& list : minLiteralLists)
+			renumber(list);
+		for (auto& list : occurrences)
+			renumber(list);
 	}
 };
 
 namespace Resolution {
 
-using ClausePair = std::pair<BitClause, BitClause>;
-using Graph = std::unordered_map<BitClause, ClausePair>;
+// Derivation of a clause, the record id is the position in the record vector
+template<int W>
+struct ProofRecord {
+	BitClause<W> clause;
+	int parentId1; // -1 for input clauses
+	int parentId2;
+};
+template<int W>
+using ProofRecords = std::vector<ProofRecord<W>>;
 
+template<int W>
 struct ProofItem {
-	ProofItem(BitClause clause = BitClause(), int index1 = -1, int index2 = -1) :
+	ProofItem(BitClause<W> clause = BitClause<W>(), int index1 = -1, int index2 = -1) :
 		clause(clause), index1(index1), index2(index2) {}
 
-	BitClause clause;
+	BitClause<W> clause;
 	int index1;
 	int index2;
 };
-using Proof = std::vector<ProofItem>;
+template<int W>
+using Proof = std::vector<ProofItem<W>>;
 
-bool clausesToBitClauses(std::vector<BitClause>& bitClauses, const Cnf& clauses) {
+// The clauses must have squeezed variable ids
+template<int W>
+void clausesToBitClauses(std::vector<BitClause<W>>& bitClauses, const Cnf& clauses) {
 	for (auto& clause : clauses) {
-		BitClause newClause;
-		for (auto& literal : clause) {
-			if (literal.varId >= sizeof(uint64_t) * 8)
-				return false;
-			uint64_t mask = static_cast<uint64_t>(1) << literal.varId;
-			if (literal.neg)
-				newClause.nLiterals |= mask;
-			else
-				newClause.pLiterals |= mask;
-		}
-		if ((newClause.pLiterals & newClause.nLiterals) == 0) {
+		BitClause<W> newClause;
+		for (auto& literal : clause)
+			newClause.addLiteral(literal.varId, literal.neg);
+		if (!newClause.isTautology()) {
 			bool notExists = true;
-			for (auto existingClause : bitClauses)
+			for (auto& existingClause : bitClauses)
 				if (newClause == existingClause)
 					notExists = false;
 			if (notExists)
@@ -208,102 +400,804 @@ bool clausesToBitClauses(std::vector<BitClause>& bitClauses, const Cnf& clauses)
 			}
 		}
 	}
-	return true;
-}
-
-bool resolve(std::set<BitClause>& unprocClauses, Graph& graph,
-	         const BucketBuff& procClauses, BitClause clause) {
-	for (int v = 0; v < BitClause::VARIABLE_COUNT; v++) {
-		const uint64_t mask = static_cast<uint64_t>(1) << v;
-		if (mask & (clause.pLiterals | clause.nLiterals)) {
-			const bool positive = mask & clause.pLiterals;
-			const auto& bucket = positive ? procClauses.nBuckets[v] : procClauses.pBuckets[v];
-			for (auto it = bucket.begin(); it != bucket.end(); it++) {
-				//p_prod++;
-				auto procClause = *it;
-				auto maskedClause = clause;
-				(positive ? maskedClause.pLiterals : maskedClause.nLiterals) &= ~mask;
-				BitClause newClause;
-				newClause.pLiterals = procClause.pLiterals | maskedClause.pLiterals;
-				newClause.nLiterals = procClause.nLiterals | maskedClause.nLiterals;
-				if ((newClause.pLiterals & newClause.nLiterals) == 0) {
-					//p_current++;
-					unprocClauses.insert(newClause);
-					if (RECORD_GRAPH) {
-						(positive ? procClause.nLiterals : procClause.pLiterals) |= mask;
-						graph.emplace(newClause, ClausePair(procClause, clause));
+}
+
+template<int W>
+struct QueuedClause {
+	BitClause<W> clause;
+	int recordId;
+	int goalDistance; // resolution steps from the negated goal
+	uint64_t age; // insertion order
+};
+
+// Unprocessed clauses, each clause once. The mask order takes the smallest clause by
+// BitClause::operator<, the other selections keep heaps with their priorities.
+template<int W>
+class ClauseQueue {
+public:
+	ClauseQueue(Options::Selection selection) : selection(selection), age(0), selectionCount(0) {}
+
+	bool empty() const {
+		return members.empty();
+	}
+
+	size_t size() const {
+		return members.size();
+	}
+
+	// Returns the record id of the queued clause and whether it was new
+	std::pair<int, bool> push(const BitClause<W>& clause, int recordId, int goalDistance) {
+		auto inserted = members.emplace(clause, recordId);
+		if (inserted.second && selection != Options::MASK_ORDER) {
+			const QueuedClause<W> queuedClause{ clause, recordId, goalDistance, age++ };
+			pushHeap(heaps[0], queuedClause, selection == Options::AGE_WEIGHT ? Options::WEIGHT : selection);
+			if (selection == Options::AGE_WEIGHT)
+				pushHeap(heaps[1], queuedClause, Options::AGE_WEIGHT);
+		}
+		else if (inserted.second)
+			goalDistances.emplace(clause, goalDistance);
+		return { inserted.first->second, inserted.second };
+	}
+
+	QueuedClause<W> pop() {
+		// every AGE_PICK_RATIO-th clause is the oldest one, the rest the lightest ones
+		const uint64_t AGE_PICK_RATIO = 5;
+		QueuedClause<W> result;
+		if (selection == Options::MASK_ORDER) {
+			auto it = members.begin();
+			auto distanceIt = goalDistances.find(it->first);
+			result = { it->first, it->second, distanceIt->second, 0 };
+			goalDistances.erase(distanceIt);
+			members.erase(it);
+			return result;
+		}
+		const bool byAge = selection == Options::AGE_WEIGHT && ++selectionCount % AGE_PICK_RATIO == 0;
+		auto& heap = heaps[byAge ? 1 : 0];
+		const Options::Selection heapSelection = byAge ? Options::AGE_WEIGHT :
+			(selection == Options::AGE_WEIGHT ? Options::WEIGHT : selection);
+		for (;;) {
+			result = popHeap(heap, heapSelection);
+			// a clause selected through the other heap is stale
+			auto it = members.find(result.clause);
+			if (it != members.end()) {
+				result.recordId = it->second;
+				members.erase(it);
+				return result;
+			}
+		}
+	}
+
+private:
+	Options::Selection selection;
+	std::map<BitClause<W>, int> members; // clause -> record id
+	std::map<BitClause<W>, int> goalDistances; // mask order only
+	std::vector<QueuedClause<W>> heaps[2]; // priority, age for AGE_WEIGHT
+	uint64_t age;
+	uint64_t selectionCount;
+
+	// true if a should be selected after b, AGE_WEIGHT stands for the age heap
+	static bool isLater(const QueuedClause<W>& a, const QueuedClause<W>& b, Options::Selection heapSelection) {
+		if (heapSelection != Options::AGE_WEIGHT) {
+			// the goal distance is a penalty, ordering by the distance alone is breadth-first
+			int weightA = a.clause.size();
+			int weightB = b.clause.size();
+			if (heapSelection == Options::GOAL_DISTANCE) {
+				weightA += a.goalDistance;
+				weightB += b.goalDistance;
+			}
+			if (weightA != weightB)
+				return weightA > weightB;
+		}
+		return a.age > b.age;
+	}
+
+	static void pushHeap(std::vector<QueuedClause<W>>& heap, const QueuedClause<W>& clause,
+		                 Options::Selection heapSelection) {
+		heap.push_back(clause);
+		std::push_heap(heap.begin(), heap.end(), [heapSelection](const QueuedClause<W>& a, const QueuedClause<W>& b) {
+			return isLater(a, b, heapSelection);
+		});
+	}
+
+	static QueuedClause<W> popHeap(std::vector<QueuedClause<W>>& heap, Options::Selection heapSelection) {
+		std::pop_heap(heap.begin(), heap.end(), [heapSelection](const QueuedClause<W>& a, const QueuedClause<W>& b) {
+			return isLater(a, b, heapSelection);
+		});
+		QueuedClause<W> result = heap.back();
+		heap.pop_back();
+		return result;
+	}
+};
+
+template<int W>
+struct Resolvent {
+	BitClause<W> clause;
+	int procIndex; // the other parent in the clause index
+};
+
+// Output of one shard of the candidate pairs
+template<int W>
+struct ResolventBuffer {
+	std::vector<Resolvent<W>> resolvents;
+	uint64_t resolventCount; // all generated ones
+	uint64_t tautologyCount;
+	uint64_t subsumedCount;
+
+	void clear() {
+		resolvents.clear();
+		resolventCount = tautologyCount = subsumedCount = 0;
+	}
+};
+
+// Unsubsumed resolvents of the clause with the processed clauses for the candidate pairs [begin, end),
+// numbered along the occurrence lists of the complementary literals in variable order. With
+// onlyVariable set both parents are resolved on their largest variable (ordered resolution).
+template<int W>
+void generateResolvents(ResolventBuffer<W>& buffer, const ClauseIndex<W>& procClauses,
+	                    const BitClause<W>& clause, int onlyVariable, size_t begin, size_t end) {
+	size_t offset = 0;
+	clause.forEachVariable([&](int v) {
+		if (onlyVariable != -1 && v != onlyVariable)
+			return false;
+		const bool positive = clause.isPositive(v);
+		const auto& complements = procClauses.occurrences[v * 2 + (positive ? 1 : 0)];
+		const size_t first = std::max(begin, offset);
+		const size_t last = std::min(end, offset + complements.size());
+		if (first < last) {
+			auto maskedClause = clause;
+			maskedClause.removeLiteral(v, !positive);
+			for (size_t i = first; i < last; i++) {
+				const int index = complements[i - offset];
+				if (procClauses.removed[index])
+					continue;
+				if (onlyVariable != -1 && procClauses.clauses[index].getMaxVariable() != v)
+					continue;
+				BitClause<W> newClause = procClauses.clauses[index];
+				newClause.removeLiteral(v, positive);
+				newClause = newClause | maskedClause;
+				buffer.resolventCount++;
+				// a clause subsumed now stays subsumed until it would be selected
+				if (newClause.isTautology())
+					buffer.tautologyCount++;
+				else if (procClauses.isSubsumed(newClause))
+					buffer.subsumedCount++;
+				else
+					buffer.resolvents.push_back({ newClause, index });
+			}
+		}
+		offset += complements.size();
+		return offset >= end;
+	});
+}
+
+// Resolves away the literals of the clause complementary to processed unit clauses, one recorded
+// step per literal. Strengthening does not move the clause away from the goal. Returns the new record id.
+template<int W>
+int strengthenByUnits(BitClause<W>& clause, int recordId, int& goalDistance, ProofRecords<W>* records,
+	                  const ClauseIndex<W>& procClauses, Stats& stats) {
+	const BitClause<W> clashing = clause.getComplementary(procClauses.units);
+	if (clashing.empty())
+		return recordId;
+	stats.strengthened++;
+	clashing.forEachVariable([&](int v) {
+		const bool positive = clashing.isPositive(v);
+		const int unitLiteral = v * 2 + (positive ? 1 : 0);
+		clause.removeLiteral(v, !positive);
+		goalDistance = std::min(goalDistance, procClauses.unitGoalDistances[unitLiteral] + 1);
+		if (records) {
+			records->push_back({ clause, procClauses.unitRecordIds[unitLiteral], recordId });
+			recordId = static_cast<int>(records->size()) - 1;
+		}
+		return false;
+	});
+	return recordId;
+}
+
+// Inserts a clause strengthened by the processed units into the unprocessed ones, a new clause gets
+// a proof record. Returns its record id.
+template<int W>
+int addUnprocClause(ClauseQueue<W>& unprocClauses, ProofRecords<W>* records, const ClauseIndex<W>& procClauses,
+	                BitClause<W>& clause, int parentId1, int parentId2, int goalDistance, Stats& stats) {
+	if (clause.getComplementary(procClauses.units).empty()) {
+		auto inserted = unprocClauses.push(clause, records ? static_cast<int>(records->size()) : -1, goalDistance);
+		if (records && inserted.second)
+			records->push_back({ clause, parentId1, parentId2 });
+		return inserted.first;
+	}
+	// the clause is recorded before it is strengthened
+	int recordId = -1;
+	if (records) {
+		recordId = static_cast<int>(records->size());
+		records->push_back({ clause, parentId1, parentId2 });
+	}
+	recordId = strengthenByUnits(clause, recordId, goalDistance, records, procClauses, stats);
+	return unprocClauses.push(clause, recordId, goalDistance).first;
+}
+
+template<int W>
+bool resolve(ClauseQueue<W>& unprocClauses, ProofRecords<W>* records, ClauseIndex<W>& procClauses,
+	         const QueuedClause<W>& given, bool ordered, std::vector<ResolventBuffer<W>>& buffers,
+	         ThreadPool* pool, Stats& stats, int& refutationId) {
+	const BitClause<W>& clause = given.clause;
+	// fewer candidate pairs are not worth waking up the pool
+	const size_t PARALLEL_MIN_PAIR_COUNT = 2048;
+	const int onlyVariable = ordered ? clause.getMaxVariable() : -1;
+	size_t pairCount = 0;
+	clause.forEachVariable([&](int v) {
+		if (onlyVariable == -1 || v == onlyVariable)
+			pairCount += procClauses.occurrences[v * 2 + (clause.isPositive(v) ? 1 : 0)].size();
+		return false;
+	});
+	const size_t shardCount = (pool && pairCount >= PARALLEL_MIN_PAIR_COUNT) ? buffers.size() : 1;
+	for (size_t i = 0; i < shardCount; i++)
+		buffers[i].clear();
+	if (shardCount == 1)
+		generateResolvents(buffers[0], procClauses, clause, onlyVariable, 0, pairCount);
+	else {
+		for (size_t i = 0; i < shardCount; i++) {
+			auto& buffer = buffers[i];
+			const size_t begin = pairCount * i / shardCount;
+			const size_t end = pairCount * (i + 1) / shardCount;
+			pool->submit([&buffer, &procClauses, &clause, onlyVariable, begin, end] {
+				generateResolvents(buffer, procClauses, clause, onlyVariable, begin, end);
+			});
+		}
+		pool->wait();
+	}
+	// the shards are merged in order, so the result does not depend on the thread count
+	for (size_t i = 0; i < shardCount; i++) {
+		stats.resolvents += buffers[i].resolventCount;
+		stats.tautologies += buffers[i].tautologyCount;
+		stats.forwardSubsumed += buffers[i].subsumedCount;
+		for (auto& resolvent : buffers[i].resolvents) {
+			const int procIndex = resolvent.procIndex;
+			// a resolvent inside its processed parent replaces it
+			if (procClauses.unitTracking && !procClauses.removed[procIndex] &&
+				resolvent.clause.isProperSubset(procClauses.clauses[procIndex])) {
+				procClauses.remove(procIndex);
+				stats.strengthened++;
+			}
+			int newRecordId = addUnprocClause(unprocClauses, records, procClauses, resolvent.clause,
+				                              procClauses.recordIds[procIndex], given.recordId,
+				                              std::min(procClauses.goalDistances[procIndex], given.goalDistance) + 1,
+				                              stats);
+			if (resolvent.clause.empty()) {
+				refutationId = newRecordId;
+				return true; // contradiction
+			}
+		}
+	}
+	return false;
+}
+
+// Resolves away the nucleus literals (negative ones for positive hyperresolution) of the clause
+// one by one, smallest variable first, with processed electrons, clauses without nucleus literals.
+// Only the final hyperresolvents become unprocessed clauses, the intermediate ones are just recorded.
+template<int W>
+bool hyperresolveNucleus(ClauseQueue<W>& unprocClauses, ProofRecords<W>* records,
+	                     const ClauseIndex<W>& procClauses, const BitClause<W>& clause, int recordId,
+	                     int goalDistance, bool neg, Stats& stats, int& refutationId) {
+	if (!clause.hasLiterals(neg)) {
+		// the hyperresolvent is recorded already
+		BitClause<W> hyperresolvent = clause;
+		recordId = strengthenByUnits(hyperresolvent, recordId, goalDistance, records, procClauses, stats);
+		if (procClauses.isSubsumed(hyperresolvent)) {
+			stats.forwardSubsumed++;
+			return false;
+		}
+		int queuedRecordId = unprocClauses.push(hyperresolvent, recordId, goalDistance).first;
+		if (hyperresolvent.empty()) {
+			refutationId = queuedRecordId;
+			return true; // contradiction
+		}
+		return false;
+	}
+	int v = -1;
+	clause.forEachVariable([&](int variable) {
+		v = variable;
+		return clause.isPositive(variable) == !neg;
+	});
+	auto maskedClause = clause;
+	maskedClause.removeLiteral(v, neg);
+	for (int index : procClauses.occurrences[v * 2 + (neg ? 0 : 1)]) {
+		const auto& electron = procClauses.clauses[index];
+		if (procClauses.removed[index] || electron.hasLiterals(neg))
+			continue;
+		BitClause<W> newClause = electron;
+		newClause.removeLiteral(v, !neg);
+		newClause = newClause | maskedClause;
+		stats.resolvents++;
+		if (newClause.isTautology()) {
+			stats.tautologies++;
+			continue;
+		}
+		int newRecordId = -1;
+		if (records) {
+			newRecordId = static_cast<int>(records->size());
+			records->push_back({ newClause, procClauses.recordIds[index], recordId });
+		}
+		if (hyperresolveNucleus(unprocClauses, records, procClauses, newClause, newRecordId, goalDistance,
+			                    neg, stats, refutationId))
+			return true;
+	}
+	return false;
+}
+
+template<int W>
+bool hyperresolve(ClauseQueue<W>& unprocClauses, ProofRecords<W>* records, const ClauseIndex<W>& procClauses,
+	              const QueuedClause<W>& given, bool neg, Stats& stats, int& refutationId) {
+	// the hyperresolvents are one step further from the goal than the given clause
+	const BitClause<W>& clause = given.clause;
+	const int recordId = given.recordId;
+	const int goalDistance = given.goalDistance + 1;
+	if (clause.hasLiterals(neg))
+		return hyperresolveNucleus(unprocClauses, records, procClauses, clause, recordId, goalDistance,
+		                           neg, stats, refutationId);
+	// an electron clashes with a nucleus literal first, the rest of the nucleus as usual
+	return clause.forEachVariable([&](int v) {
+		auto maskedClause = clause;
+		maskedClause.removeLiteral(v, !neg);
+		for (int index : procClauses.occurrences[v * 2 + (neg ? 1 : 0)]) {
+			if (procClauses.removed[index])
+				continue;
+			BitClause<W> newClause = procClauses.clauses[index];
+			newClause.removeLiteral(v, neg);
+			newClause = newClause | maskedClause;
+			stats.resolvents++;
+			if (newClause.isTautology()) {
+				stats.tautologies++;
+				continue;
+			}
+			int newRecordId = -1;
+			if (records) {
+				newRecordId = static_cast<int>(records->size());
+				records->push_back({ newClause, procClauses.recordIds[index], recordId });
+			}
+			if (hyperresolveNucleus(unprocClauses, records, procClauses, newClause, newRecordId, goalDistance,
+				                    neg, stats, refutationId))
+				return true;
+		}
+		return false;
+	});
+}
+
+template<int W>
+struct InputClause {
+	BitClause<W> clause;
+	int recordId;
+	bool axiom; // derived from the axioms only
+};
+
+// Input clauses in the order axioms, goal clauses, each recorded without parents
+template<int W>
+void makeInputClauses(std::vector<InputClause<W>>& inputs, ProofRecords<W>* records,
+	                  const std::vector<BitClause<W>>& axioms, const std::vector<BitClause<W>>& goalClauses) {
+	for (size_t i = 0; i < axioms.size() + goalClauses.size(); i++) {
+		const bool axiom = i < axioms.size();
+		const auto& clause = axiom ? axioms[i] : goalClauses[i - axioms.size()];
+		inputs.push_back({ clause, records ? static_cast<int>(records->size()) : -1, axiom });
+		if (records)
+			records->push_back({ clause, -1, -1 });
+	}
+}
+
+// Unit propagation and pure literal elimination over the input clauses until nothing changes.
+// Clauses containing a unit or a pure literal are dropped, the literals complementary to a unit
+// are resolved away. Returns true if the empty clause is derived, refutationId is set then.
+template<int W>
+bool simplifyInput(std::vector<InputClause<W>>& clauses, int variableCount, ProofRecords<W>* records,
+	               Stats& stats, int& refutationId) {
+	std::vector<int> unitRecordIds(variableCount * 2);
+	std::vector<bool> unitAxioms(variableCount * 2);
+	for (bool changed = true; changed;) {
+		changed = false;
+		BitClause<W> units;
+		for (auto& input : clauses) {
+			if (input.clause.empty()) {
+				refutationId = input.recordId;
+				return true;
+			}
+			if (input.clause.size() != 1)
+				continue;
+			const int v = input.clause.getMaxVariable();
+			const bool positive = input.clause.isPositive(v);
+			const int literal = v * 2 + (positive ? 0 : 1);
+			if (!input.clause.getComplementary(units).empty()) {
+				refutationId = -1;
+				if (records) {
+					refutationId = static_cast<int>(records->size());
+					records->push_back({ BitClause<W>(), unitRecordIds[literal ^ 1], input.recordId });
+				}
+				return true;
+			}
+			if (input.clause.getCommon(units).empty()) {
+				units.addLiteral(v, !positive);
+				unitRecordIds[literal] = input.recordId;
+				unitAxioms[literal] = input.axiom;
+			}
+		}
+
+		size_t kept = 0;
+		for (auto input : clauses) {
+			const BitClause<W> common = input.clause.getCommon(units);
+			if (!common.empty()) {
+				const int v = common.getMaxVariable();
+				const int literal = v * 2 + (common.isPositive(v) ? 0 : 1);
+				if (input.clause.size() != 1 || unitRecordIds[literal] != input.recordId) {
+					stats.forwardSubsumed++;
+					continue;
+				}
+			}
+			const BitClause<W> clashing = input.clause.getComplementary(units);
+			if (!clashing.empty()) {
+				stats.strengthened++;
+				clashing.forEachVariable([&](int v) {
+					const bool positive = clashing.isPositive(v);
+					const int unitLiteral = v * 2 + (positive ? 1 : 0);
+					input.clause.removeLiteral(v, !positive);
+					input.axiom = input.axiom && unitAxioms[unitLiteral];
+					if (records) {
+						records->push_back({ input.clause, unitRecordIds[unitLiteral], input.recordId });
+						input.recordId = static_cast<int>(records->size()) - 1;
 					}
-					if (newClause.empty())
-						return true; // contradiction
+					return false;
+				});
+				if (input.clause.empty()) {
+					refutationId = input.recordId;
+					return true;
 				}
+				changed = true;
+			}
+			clauses[kept++] = input;
+		}
+		clauses.resize(kept);
+
+		BitClause<W> literals;
+		for (auto& input : clauses)
+			literals = literals | input.clause;
+		const BitClause<W> pure = literals.getPure();
+		if (pure.empty())
+			continue;
+		kept = 0;
+		for (auto& input : clauses) {
+			if (!input.clause.getCommon(pure).empty()) {
+				stats.pureLiteralClauses++;
+				changed = true;
+				continue;
 			}
+			clauses[kept++] = input;
 		}
+		clauses.resize(kept);
 	}
 	return false;
 }
 
-bool resolve(Graph& graph, const std::vector<BitClause>& clauses) {
-	std::vector<BitClause> procClauses;
-	BucketBuff procClausesB;
-	std::set<BitClause> unprocClauses;
+// Replaces the processed clauses containing the complement of the unit clause by their resolvents
+// with it, which are queued to be resolved with the rest again.
+template<int W>
+bool propagateUnit(ClauseQueue<W>& unprocClauses, ProofRecords<W>* records, ClauseIndex<W>& procClauses,
+	               const QueuedClause<W>& unit, Stats& stats, int& refutationId) {
+	const int v = unit.clause.getMaxVariable();
+	const bool positive = unit.clause.isPositive(v);
+	for (int index : procClauses.occurrences[v * 2 + (positive ? 1 : 0)]) {
+		if (procClauses.removed[index])
+			continue;
+		BitClause<W> newClause = procClauses.clauses[index];
+		newClause.removeLiteral(v, positive);
+		procClauses.remove(index);
+		stats.strengthened++;
+		int newRecordId = addUnprocClause(unprocClauses, records, procClauses, newClause,
+			                              procClauses.recordIds[index], unit.recordId,
+			                              std::min(procClauses.goalDistances[index], unit.goalDistance) + 1, stats);
+		if (newClause.empty()) {
+			refutationId = newRecordId;
+			return true; // contradiction
+		}
+	}
+	return false;
+}
 
-	for (auto clause : clauses) {
-		unprocClauses.insert(clause);
-		if (RECORD_GRAPH)
-			graph[clause] = ClausePair();
+// Given-clause saturation of the goal clauses and the axioms. With the set of support the axioms
+// are processed clauses from the start, so they are never resolved with each other. The counters
+// are added to the statistics, the phases are timed only when the caller asked for the statistics.
+template<int W>
+bool resolve(ProofRecords<W>* records, int& refutationId, const std::vector<BitClause<W>>& goalClauses,
+	         const std::vector<BitClause<W>>& axioms, int variableCount, const Options& options, Stats& stats,
+	         Budget* budget = nullptr, bool* interrupted = nullptr) {
+	PhaseTimer timer(options.stats != nullptr);
+	ClauseIndex<W> procClauses(variableCount, options.simplification);
+	ClauseQueue<W> unprocClauses(options.selection);
+	std::unique_ptr<ThreadPool> pool;
+	if (options.threadCount != 1)
+		pool.reset(new ThreadPool(options.threadCount));
+	std::vector<ResolventBuffer<W>> buffers(pool ? pool->getThreadCount() : 1);
+
+	std::vector<InputClause<W>> inputs;
+	makeInputClauses(inputs, records, axioms, goalClauses);
+	if (options.simplification && simplifyInput(inputs, variableCount, records, stats, refutationId))
+		return true;
+	timer.stop(stats.simplificationTime);
+	for (auto& input : inputs) {
+		if (!input.axiom || options.strategy != Options::SET_OF_SUPPORT) {
+			unprocClauses.push(input.clause, input.recordId, input.axiom ? 1 : 0);
+			continue;
+		}
+		if (input.clause.empty()) {
+			refutationId = input.recordId;
+			return true; // contradiction given as input
+		}
+		if (procClauses.isSubsumed(input.clause)) {
+			stats.forwardSubsumed++;
+			continue;
+		}
+		stats.backwardSubsumed += procClauses.removeSubsumed(input.clause);
+		procClauses.add(input.clause, input.recordId, 1);
 	}
+	stats.peakProcessed = std::max(stats.peakProcessed, procClauses.size());
 
-	while (unprocClauses.size()) {
-		//p_iter++;
-		auto it = unprocClauses.begin();
-		BitClause clause = *it;
-		unprocClauses.erase(it);
+	while (!unprocClauses.empty()) {
+		stats.peakUnprocessed = std::max(stats.peakUnprocessed, unprocClauses.size());
+		// rough estimate: queue entries, index entries and proof records
+		const size_t memoryUsage = (unprocClauses.size() * 3 + procClauses.size() * 2) * sizeof(BitClause<W>) +
+			                       (records ? records->size() * sizeof(ProofRecord<W>) : 0);
+		if (budget && budget->isExceeded(1, memoryUsage)) {
+			if (interrupted)
+				*interrupted = true;
+			return false;
+		}
+		QueuedClause<W> given = unprocClauses.pop();
+		stats.givenClauses++;
+		// units processed after the clause was queued
+		given.recordId = strengthenByUnits(given.clause, given.recordId, given.goalDistance, records,
+			                               procClauses, stats);
+		timer.stop(stats.selectionTime);
+		if (given.clause.empty()) {
+			refutationId = given.recordId;
+			return true; // contradiction given as input
+		}
 
-		bool add = true;
-		for (int i = 0; i < procClauses.size(); i++) {
-			//p_exists++;
-			if (procClauses[i].isSubset(clause)) {
-				add = false;
-				break;
+		if (procClauses.isSubsumed(given.clause)) {
+			stats.forwardSubsumed++;
+			timer.stop(stats.subsumptionTime);
+			continue;
+		}
+		stats.backwardSubsumed += procClauses.removeSubsumed(given.clause);
+		if (procClauses.unitTracking && given.clause.size() == 1 &&
+			propagateUnit(unprocClauses, records, procClauses, given, stats, refutationId))
+			return true;
+		timer.stop(stats.subsumptionTime);
+		bool contradiction;
+		switch (options.strategy) {
+		case Options::POSITIVE_HYPERRESOLUTION:
+		case Options::NEGATIVE_HYPERRESOLUTION:
+			contradiction = hyperresolve(unprocClauses, records, procClauses, given,
+				                         options.strategy == Options::POSITIVE_HYPERRESOLUTION, stats, refutationId);
+			break;
+		default:
+			contradiction = resolve(unprocClauses, records, procClauses, given, options.strategy == Options::ORDERED,
+				                    buffers, pool.get(), stats, refutationId);
+		}
+		timer.stop(stats.generationTime);
+		if (contradiction)
+			return true;
+		procClauses.add(given.clause, given.recordId, given.goalDistance);
+		stats.peakProcessed = std::max(stats.peakProcessed, procClauses.size());
+	}
+
+	return false;
+}
+
+// Davis-Putnam procedure: the variable with the fewest resolvent candidates is eliminated by
+// replacing all its clauses with their resolvents on it, until the empty clause is derived or no
+// clause is left. Only the current clause set is kept, the eliminated clauses are kept in the proof
+// records only. An eliminated variable is a step.
+template<int W>
+bool eliminateVariables(ProofRecords<W>* records, int& refutationId, const std::vector<BitClause<W>>& goalClauses,
+	                    const std::vector<BitClause<W>>& axioms, int variableCount, const Options& options,
+	                    Stats& stats, Budget* budget = nullptr, bool* interrupted = nullptr) {
+	PhaseTimer timer(options.stats != nullptr);
+	std::vector<InputClause<W>> inputs;
+	makeInputClauses(inputs, records, axioms, goalClauses);
+	if (options.simplification && simplifyInput(inputs, variableCount, records, stats, refutationId))
+		return true;
+	timer.stop(stats.simplificationTime);
+	ClauseIndex<W> index(variableCount, false);
+	for (auto& input : inputs) {
+		if (input.clause.empty()) {
+			refutationId = input.recordId;
+			return true; // contradiction given as input
+		}
+		if (index.isSubsumed(input.clause)) {
+			stats.forwardSubsumed++;
+			continue;
+		}
+		stats.backwardSubsumed += index.removeSubsumed(input.clause);
+		index.add(input.clause, input.recordId, 0);
+	}
+
+	std::vector<std::pair<BitClause<W>, int>> parents[2]; // clause, record id
+	for (;;) {
+		stats.peakProcessed = std::max(stats.peakProcessed, index.size());
+		const size_t memoryUsage = index.size() * 2 * sizeof(BitClause<W>) +
+			                       (records ? records->size() * sizeof(ProofRecord<W>) : 0);
+		if (budget && budget->isExceeded(1, memoryUsage)) {
+			if (interrupted)
+				*interrupted = true;
+			return false;
+		}
+		// min-occurrence order: the fewest resolvent candidates, then the fewest clauses
+		int variable = -1;
+		uint64_t bestProduct = 0;
+		int bestSum = 0;
+		for (int v = 0; v < variableCount; v++) {
+			const int positiveCount = index.literalCounts[v * 2];
+			const int negativeCount = index.literalCounts[v * 2 + 1];
+			if (positiveCount + negativeCount == 0)
+				continue;
+			const uint64_t product = static_cast<uint64_t>(positiveCount) * negativeCount;
+			if (variable == -1 || product < bestProduct ||
+				(product == bestProduct && positiveCount + negativeCount < bestSum)) {
+				variable = v;
+				bestProduct = product;
+				bestSum = positiveCount + negativeCount;
+			}
+		}
+		if (variable == -1)
+			return false; // no clause left, satisfiable
+		stats.eliminatedVariables++;
+		timer.stop(stats.selectionTime);
+
+		// the parents are copied out, adding the resolvents may compact the index
+		for (int sign = 0; sign < 2; sign++) {
+			parents[sign].clear();
+			for (int i : index.occurrences[variable * 2 + sign]) {
+				if (index.removed[i])
+					continue;
+				parents[sign].push_back({ index.clauses[i], index.recordIds[i] });
+				index.remove(i);
 			}
 		}
-		if (add) {
-			//p_proc++;
-			for (int i = 0; i < procClauses.size(); i++) {
-				//p_removetest++;
-				auto& procClause = procClauses[i];
-				if (clause.isProperSubset(procClause)) {
-					procClausesB.removeClause(procClause);
-					std::swap(procClause, procClauses.back());
-					procClauses.pop_back();
-					i--;
+		for (auto& positive : parents[0]) {
+			auto maskedClause = positive.first;
+			maskedClause.removeLiteral(variable, false);
+			for (auto& negative : parents[1]) {
+				BitClause<W> resolvent = negative.first;
+				resolvent.removeLiteral(variable, true);
+				resolvent = resolvent | maskedClause;
+				stats.resolvents++;
+				if (resolvent.isTautology()) {
+					stats.tautologies++;
+					continue;
+				}
+				int recordId = -1;
+				if (!resolvent.empty()) {
+					if (index.isSubsumed(resolvent)) {
+						stats.forwardSubsumed++;
+						continue;
+					}
+					stats.backwardSubsumed += index.removeSubsumed(resolvent);
+				}
+				if (records) {
+					recordId = static_cast<int>(records->size());
+					records->push_back({ resolvent, positive.second, negative.second });
+				}
+				if (resolvent.empty()) {
+					refutationId = recordId;
+					return true; // contradiction
 				}
+				index.add(resolvent, recordId, 0);
 			}
-			if (resolve(unprocClauses, graph, procClausesB, clause))
-				return true;
-			procClausesB.addClause(clause);
-			procClauses.push_back(clause);
 		}
+		if (index.clauses.size() > index.size() * 2)
+			index.compact();
+		timer.stop(stats.generationTime);
 	}
+}
 
-	return false;
+// ZRes: the Davis-Putnam procedure on the clause set stored as a ZBDD over the literals
+// 2 * variable + negative. The resolvents on a variable are the product of its two cofactors without
+// the tautologies and subsumption is a set operation, so the clauses are never enumerated one by one.
+// Any number of variables, but no proof steps.
+bool eliminateVariablesSymbolically(const Cnf& clauses, int variableCount, const Options& options, Stats& stats,
+	                                Budget* budget, bool* interrupted) {
+	PhaseTimer timer(options.stats != nullptr);
+	Zbdd zbdd(budget);
+	Zbdd::Node clauseSet = Zbdd::EMPTY;
+	std::vector<int> literals;
+	std::vector<uint64_t> literalCounts;
+	for (auto& clause : clauses) {
+		literals.clear();
+		for (auto& literal : clause)
+			literals.push_back(literal.varId * 2 + (literal.neg ? 1 : 0));
+		clauseSet = zbdd.unite(clauseSet, zbdd.makeSet(literals));
+	}
+	clauseSet = zbdd.minimize(zbdd.removeComplementary(clauseSet));
+	timer.stop(stats.simplificationTime);
+
+	for (;;) {
+		stats.zbddNodes = zbdd.getNodeCount();
+		// an interrupted step leaves a meaningless clause set
+		if (zbdd.isInterrupted() || (budget && budget->isExceeded(1, zbdd.getMemoryUsage()))) {
+			if (interrupted)
+				*interrupted = true;
+			return false;
+		}
+		stats.peakProcessed = std::max(stats.peakProcessed, static_cast<size_t>(zbdd.count(clauseSet)));
+		if (zbdd.containsEmptySet(clauseSet))
+			return true; // contradiction
+		if (clauseSet == Zbdd::EMPTY)
+			return false; // no clause left, satisfiable
+		// min-occurrence order as in eliminateVariables, counted on the cofactors
+		literalCounts.assign(variableCount * 2, 0);
+		zbdd.countElements(clauseSet, literalCounts);
+		int variable = -1;
+		uint64_t bestProduct = 0;
+		uint64_t bestSum = 0;
+		for (int v = 0; v < variableCount; v++) {
+			const uint64_t positiveCount = literalCounts[v * 2];
+			const uint64_t negativeCount = literalCounts[v * 2 + 1];
+			if (positiveCount + negativeCount == 0)
+				continue;
+			const uint64_t product = negativeCount && positiveCount > UINT64_MAX / negativeCount ?
+				UINT64_MAX : positiveCount * negativeCount;
+			if (variable == -1 || product < bestProduct ||
+				(product == bestProduct && positiveCount + negativeCount < bestSum)) {
+				variable = v;
+				bestProduct = product;
+				bestSum = positiveCount + negativeCount;
+			}
+		}
+		stats.eliminatedVariables++;
+		timer.stop(stats.selectionTime);
+
+		const Zbdd::Node resolvents = zbdd.product(zbdd.subset1(clauseSet, variable * 2),
+			                                       zbdd.subset1(clauseSet, variable * 2 + 1));
+		const Zbdd::Node nonTautologies = zbdd.removeComplementary(resolvents);
+		const Zbdd::Node minimal = zbdd.minimize(nonTautologies);
+		const Zbdd::Node rest = zbdd.subset0(zbdd.subset0(clauseSet, variable * 2), variable * 2 + 1);
+		// the rest is minimal already, a resolvent equal to a clause of the rest is not new
+		const Zbdd::Node added = zbdd.removeSupersets(minimal, rest);
+		const Zbdd::Node kept = zbdd.removeSupersets(rest, added);
+		const uint64_t nonTautologyCount = zbdd.count(nonTautologies);
+		stats.resolvents += zbdd.count(resolvents);
+		stats.tautologies += zbdd.count(resolvents) - nonTautologyCount;
+		stats.forwardSubsumed += nonTautologyCount - zbdd.count(added);
+		stats.backwardSubsumed += zbdd.count(rest) - zbdd.count(kept);
+		clauseSet = zbdd.unite(kept, added);
+		// the old operands are not asked for again
+		zbdd.clearCache();
+		timer.stop(stats.generationTime);
+	}
 }
 
-int traverseProof(Proof& proof, const Graph& graph, BitClause clause = BitClause()) {
-	for (int i = 0; i < proof.size(); i++)
-		if (proof[i].clause == clause)
-			return i;
-	ProofItem item(clause);
-	auto it = graph.find(clause);
-	assert(it != graph.end());
-	const ClausePair& pair = it->second;
-	if (!pair.first.empty()) {
-		assert(!pair.second.empty());
-		item.index1 = traverseProof(proof, graph, pair.first);
-		item.index2 = traverseProof(proof, graph, pair.second);
+// Post-order over the parents of the refutation, each record once
+template<int W>
+void traverseProof(Proof<W>& proof, const ProofRecords<W>& records, int refutationId) {
+	std::vector<int> proofIndexes(records.size(), -1); // record id -> proof index
+	std::vector<std::pair<int, bool>> stack; // record id, parents visited
+	stack.push_back({ refutationId, false });
+	while (!stack.empty()) {
+		const int recordId = stack.back().first;
+		const bool parentsVisited = stack.back().second;
+		stack.pop_back();
+		if (proofIndexes[recordId] != -1)
+			continue;
+		const ProofRecord<W>& record = records[recordId];
+		if (record.parentId1 != -1 && !parentsVisited) {
+			assert(record.parentId2 != -1);
+			stack.push_back({ recordId, true });
+			stack.push_back({ record.parentId2, false });
+			stack.push_back({ record.parentId1, false });
+			continue;
+		}
+		ProofItem<W> item(record.clause);
+		if (record.parentId1 != -1) {
+			item.index1 = proofIndexes[record.parentId1];
+			item.index2 = proofIndexes[record.parentId2];
+		}
+		proofIndexes[recordId] = static_cast<int>(proof.size());
+		proof.push_back(item);
 	}
-	proof.push_back(item);
-	return static_cast<int>(proof.size() - 1);
 }
 
 std::string getVariableName(VariableId id) {
@@ -317,129 +1211,305 @@ std::string getVariableName(VariableId id) {
 	return result;
 }
 
-std::string bitClauseToStr(BitClause clause) {
-	std::string result;
-	if ((clause.pLiterals | clause.nLiterals) == 0)
-		return "F";
-	const std::string op = " | ";
-	for (int v = 0; v < BitClause::VARIABLE_COUNT; v++) {
-		auto varName = getVariableName(v);
-		uint64_t mask = static_cast<uint64_t>(1) << v;
-		if (clause.pLiterals & mask)
-			result += varName + op;
-		if (clause.nLiterals & mask)
-			result += std::string("~") + varName + op;
-	}
-	result.erase(result.length() - op.length());
-	return result;
+size_t getNumberLength(size_t number) {
+	size_t length = 1;
+	for (; number >= 10; number /= 10)
+		length++;
+	return length;
 }
 
-std::string renderProof(const Graph& graph) {
-	Proof proof;
-	traverseProof(proof, graph);
+size_t getVariableNameLength(VariableId id) {
+	const int CHARACTER_COUNT = 'z' - 'a' + 1;
+	int number = id / CHARACTER_COUNT;
+	return number > 0 ? 1 + getNumberLength(number) : 1;
+}
+
+const char* const LITERAL_SEPARATOR = " | ";
 
-	std::vector<std::string> lines;
+// Length of the clause as written by writeClause
+template<int W>
+size_t getClauseLength(const BitClause<W>& clause, const std::vector<VariableId>& originalIds) {
+	if (clause.empty())
+		return 1;
+	size_t length = 0;
+	clause.forEachVariable([&](int v) {
+		length += getVariableNameLength(originalIds[v]) + (clause.isPositive(v) ? 0 : 1) + 3;
+		return false;
+	});
+	return length - 3;
+}
+
+template<int W>
+void writeClause(std::ostream& out, const BitClause<W>& clause, const std::vector<VariableId>& originalIds) {
+	if (clause.empty()) {
+		out << 'F';
+		return;
+	}
+	bool first = true;
+	clause.forEachVariable([&](int v) {
+		if (!first)
+			out << LITERAL_SEPARATOR;
+		first = false;
+		if (!clause.isPositive(v))
+			out << '~';
+		out << getVariableName(originalIds[v]);
+		return false;
+	});
+}
+
+template<int W>
+void renderProof(std::ostream& out, const ProofRecords<W>& records, int refutationId,
+	             const std::vector<VariableId>& originalIds) {
+	Proof<W> proof;
+	traverseProof(proof, records, refutationId);
+
+	// the width of the justification column is known before anything is written
+	std::vector<size_t> clauseLengths(proof.size());
+	std::vector<size_t> lineLengths(proof.size());
 	size_t lineMaxLength = 0;
-	for (int i = 0; i < proof.size(); i++)
-	{
-		std::string line;
-		line += std::to_string(i + 1) + ". ";
-		if (proof[i].index1 == -1) {
-			assert(proof[i].index2 == -1);
-			line += std::string("(");
-			line += bitClauseToStr(proof[i].clause);
-			line += std::string(")");
-		}
-		else {
-			line += std::string("(");
-			line += bitClauseToStr(proof[proof[i].index1].clause);
-			line += std::string(") & (");
-			line += bitClauseToStr(proof[proof[i].index2].clause);
-			line += std::string(") -> (");
-			line += bitClauseToStr(proof[i].clause);
-			line += std::string(")");
-		}
-		lines.push_back(line);
-		lineMaxLength = std::max(lineMaxLength, line.length());
+	for (int i = 0; i < proof.size(); i++) {
+		clauseLengths[i] = getClauseLength(proof[i].clause, originalIds);
+		size_t length = getNumberLength(i + 1) + 2 + clauseLengths[i] + 2;
+		if (proof[i].index1 != -1)
+			length += clauseLengths[proof[i].index1] + clauseLengths[proof[i].index2] + 11;
+		lineLengths[i] = length;
+		lineMaxLength = std::max(lineMaxLength, length);
 	}
 	const int SPACE_SIZE = 4;
-	std::string result;
-	for (int i = 0; i < proof.size(); i++)
-	{
-		std::string line = lines[i];
-		line.insert(line.length(), (lineMaxLength + SPACE_SIZE) - line.length(), ' ');
-		if (proof[i].index1 == -1) {
-			line += "[cnf transformation 0]";
-		}
-		else {
-			line += std::string("[resolution ");
-			line += std::to_string(proof[i].index1 + 1);
-			line += std::string(", ");
-			line += std::to_string(proof[i].index2 + 1);
-			line += std::string("]");
-		}
-		result += line + "\n";
+	const std::string spaces(lineMaxLength + SPACE_SIZE, ' ');
+	for (int i = 0; i < proof.size(); i++) {
+		out << i + 1 << ". (";
+		if (proof[i].index1 != -1) {
+			writeClause(out, proof[proof[i].index1].clause, originalIds);
+			out << ") & (";
+			writeClause(out, proof[proof[i].index2].clause, originalIds);
+			out << ") -> (";
+		}
+		writeClause(out, proof[i].clause, originalIds);
+		out << ')';
+		out.write(spaces.data(), lineMaxLength + SPACE_SIZE - lineLengths[i]);
+		if (proof[i].index1 == -1)
+			out << "[cnf transformation 0]\n";
+		else
+			out << "[resolution " << proof[i].index1 + 1 << ", " << proof[i].index2 + 1 << "]\n";
 	}
-	return result;
 }
 
-bool isValid(const PropositionSP& proposition, std::string* proof) {
-	auto notProposition = std::make_shared<UnaryOperator>(proposition, UnaryOperator::NOT);
-	bool result = isContradiction(notProposition, proof);
-	if (proof)
-		*proof = "Proof by refutation:\n" + *proof;
+using ProofRenderer = std::function<void(std::ostream&)>;
+
+// *renderer is set to write the refutation if the proof is requested and found.
+// The first axiomCount clauses do not belong to the negated goal.
+template<int W>
+bool resolveCnf(const Cnf& clauses, size_t axiomCount, const std::vector<VariableId>& originalIds,
+	            const Options& options, Stats& stats, Budget* budget, bool* interrupted,
+	            ProofRenderer* renderer) {
+	std::vector<BitClause<W>> axioms;
+	std::vector<BitClause<W>> goalClauses;
+	clausesToBitClauses(axioms, Cnf(clauses.begin(), clauses.begin() + axiomCount));
+	clausesToBitClauses(goalClauses, Cnf(clauses.begin() + axiomCount, clauses.end()));
+	// records are only kept when the proof is requested
+	ProofRecords<W> records;
+	int refutationId = -1;
+	const int variableCount = static_cast<int>(originalIds.size());
+	bool result;
+	if (options.strategy == Options::DAVIS_PUTNAM)
+		result = eliminateVariables(renderer ? &records : nullptr, refutationId, goalClauses, axioms,
+			                        variableCount, options, stats, budget, interrupted);
+	else
+		result = resolve(renderer ? &records : nullptr, refutationId, goalClauses, axioms,
+			             variableCount, options, stats, budget, interrupted);
+	if (!result && options.strategy == Options::SET_OF_SUPPORT && !axioms.empty() &&
+		!(interrupted && *interrupted)) {
+		// the set of support is complete only for consistent axioms
+		Cnf axiomClauses(clauses.begin(), clauses.begin() + axiomCount);
+		squeezeVariableIds(axiomClauses);
+		DpllCnfSat dpll(axiomClauses);
+		dpll.setBudget(budget);
+		if (!dpll.isSatisfiable() && !dpll.isInterrupted()) {
+			Options saturation = options;
+			saturation.strategy = Options::SATURATION;
+			records.clear();
+			result = resolve(renderer ? &records : nullptr, refutationId, axioms, std::vector<BitClause<W>>(),
+				             variableCount, saturation, stats, budget, interrupted);
+		}
+		else if (dpll.isInterrupted() && interrupted)
+			*interrupted = true;
+	}
+	if (result && renderer) {
+		auto sharedRecords = std::make_shared<ProofRecords<W>>(std::move(records));
+		*renderer = [sharedRecords, refutationId, originalIds](std::ostream& out) {
+			renderProof(out, *sharedRecords, refutationId, originalIds);
+		};
+	}
 	return result;
 }
 
-bool isContradiction(const PropositionSP& proposition, std::string* proof) {
-	std::vector<Clause> clauses;
+// The clause width is picked by the number of distinct variables
+bool resolveCnf(Cnf& clauses, size_t axiomCount, const Options& options, Stats& stats,
+	            Budget* budget, bool* interrupted, ProofRenderer* renderer = nullptr) {
+	std::vector<VariableId> originalIds;
+	squeezeVariableIds(clauses, originalIds, 0);
+	const size_t variableCount = originalIds.size();
+	if (options.strategy == Options::ZRES) {
+		const bool result = eliminateVariablesSymbolically(clauses, static_cast<int>(variableCount), options, stats,
+			                                               budget, interrupted);
+		if (result && renderer)
+			*renderer = [](std::ostream& out) {
+				out << "The empty clause is derived symbolically (ZRes), the resolution steps are not recorded\n";
+			};
+		return result;
+	}
+	if (variableCount <= BitClause<1>::VARIABLE_COUNT)
+		return resolveCnf<1>(clauses, axiomCount, originalIds, options, stats, budget, interrupted,
+		                     renderer);
+	if (variableCount <= BitClause<2>::VARIABLE_COUNT)
+		return resolveCnf<2>(clauses, axiomCount, originalIds, options, stats, budget, interrupted,
+		                     renderer);
+	if (variableCount <= BitClause<4>::VARIABLE_COUNT)
+		return resolveCnf<4>(clauses, axiomCount, originalIds, options, stats, budget, interrupted,
+		                     renderer);
+	if (variableCount <= BitClause<8>::VARIABLE_COUNT)
+		return resolveCnf<8>(clauses, axiomCount, originalIds, options, stats, budget, interrupted,
+		                     renderer);
+	throw std::runtime_error("Variable count is greater than " + std::to_string(MAX_VARIABLE_COUNT));
+}
+
+// Splits ~(A -> B) into the axioms A and the negated goal ~B, otherwise everything is the goal
+size_t propositionToSupportedCnf(Cnf& clauses, const PropositionSP& proposition) {
+	if (proposition->getType() == Proposition::UNARY) {
+		auto unary = std::static_pointer_cast<UnaryOperator>(proposition);
+		auto operand = unary->getOperand();
+		if (unary->getOp() == UnaryOperator::NOT && operand->getType() == Proposition::BINARY) {
+			auto binary = std::static_pointer_cast<BinaryOperator>(operand);
+			PropositionSP axioms;
+			PropositionSP goal;
+			if (binary->getOp() == BinaryOperator::IMP) {
+				axioms = binary->getLeft();
+				goal = binary->getRight();
+			}
+			else if (binary->getOp() == BinaryOperator::RIMP) {
+				axioms = binary->getRight();
+				goal = binary->getLeft();
+			}
+			if (axioms) {
+				propositionToCnf(clauses, axioms);
+				const size_t axiomCount = clauses.size();
+				Cnf goalClauses;
+				propositionToCnf(goalClauses, std::make_shared<UnaryOperator>(goal, UnaryOperator::NOT));
+				clauses.insert(clauses.end(), goalClauses.begin(), goalClauses.end());
+				return axiomCount;
+			}
+		}
+	}
 	propositionToCnf(clauses, proposition);
-	if(!RECORD_GRAPH)
-		squeezeVariableIds(clauses);
-	std::vector<BitClause> bitClauses;
-	if (!clausesToBitClauses(bitClauses, clauses))
-		throw std::runtime_error("Variable id is greater than 63");
-	clauses.clear();
-	clauses.shrink_to_fit();
+	return 0;
+}
+
+Budget::Answer checkContradiction(const PropositionSP& proposition, const Options& options, Budget* budget,
+	                              std::ostream* proof) {
+	Stats stats;
+	PhaseTimer timer(options.stats != nullptr);
+	std::vector<Clause> clauses;
+	size_t axiomCount = 0;
+	if (options.strategy == Options::SET_OF_SUPPORT || options.selection == Options::GOAL_DISTANCE)
+		axiomCount = propositionToSupportedCnf(clauses, proposition);
+	else
+		propositionToCnf(clauses, proposition);
+	timer.stop(stats.cnfTime);
 
 	auto start = std::chrono::high_resolution_clock::now();
 
-	Graph graph;
-	auto result = resolve(graph, bitClauses);
+	bool interrupted = false;
+	ProofRenderer renderer;
+	auto result = resolveCnf(clauses, axiomCount, options, stats, budget, &interrupted,
+		                     proof ? &renderer : nullptr);
+	timer.stop(stats.saturationTime);
 
 	auto end = std::chrono::high_resolution_clock::now();
 	auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
-	/*std::cout << "p_iter: " << p_iter << std::endl;
-	std::cout << "p_prod: " << p_prod << std::endl;
-	std::cout << "p_current: " << p_current << std::endl;
-	std::cout << "p_exists: " << p_exists << std::endl;
-	std::cout << "p_removetest: " << p_removetest << std::endl;
-	std::cout << "p_proc: " << p_proc << std::endl;
-	std::cout << "p_add: " << p_add << std::endl;
-	std::cout << "p_remove: " << p_remove << std::endl;
-	std::cout << std::endl;*/
-
 	if (proof) {
 		if (result) {
-			std::string str;
-			if (RECORD_GRAPH) {
-				str = "0. ";
-				Converter converter;
-				str += converter.toString(proposition) + "\n";
-				str += renderProof(graph);
-			}
-			*proof += str;
-			*proof += "Contradiction found\n";
-			if(!RECORD_GRAPH)
-				*proof += "Proof unavailable\n";
+			Converter converter;
+			*proof << "0. " << converter.toString(proposition) << "\n";
+			renderer(*proof);
+			timer.stop(stats.proofTime);
+			*proof << "Contradiction found\n";
 		}
+		else if (interrupted)
+			*proof << "Budget exceeded\n";
 		else
-			*proof += "Contradiction not found\n";
-		*proof += "Elapsed time: ";
-		*proof += std::to_string((double)duration.count() / 1000000) + "s\n";
+			*proof << "Contradiction not found\n";
+		const char* const SELECTION_NAMES[] = { "mask order", "weight", "age/weight", "goal distance" };
+		if (options.strategy == Options::DAVIS_PUTNAM || options.strategy == Options::ZRES)
+			*proof << "Eliminated variables: " << stats.eliminatedVariables << "\n";
+		else
+			*proof << "Given clauses: " << stats.givenClauses << " (" << SELECTION_NAMES[options.selection] << ")\n";
+		*proof << "Elapsed time: ";
+		*proof << std::to_string((double)duration.count() / 1000000) << "s\n";
 	}
 
+	if (options.stats)
+		*options.stats = stats;
+	if (interrupted)
+		return Budget::UNKNOWN;
+	return Budget::toAnswer(result);
+}
+
+// The string variants render into a buffer and append it
+Budget::Answer checkContradiction(const PropositionSP& proposition, const Options& options, Budget* budget,
+	                              std::string* proof, bool refutation) {
+	if (!proof)
+		return checkContradiction(proposition, options, budget, static_cast<std::ostream*>(nullptr));
+	std::ostringstream out;
+	if (refutation)
+		out << "Proof by refutation:\n";
+	Budget::Answer result = checkContradiction(proposition, options, budget, &out);
+	*proof += out.str();
+	return result;
+}
+
+PropositionSP negate(const PropositionSP& proposition) {
+	return std::make_shared<UnaryOperator>(proposition, UnaryOperator::NOT);
+}
+
+bool isValid(const PropositionSP& proposition, std::string* proof, const Options& options) {
+	return checkContradiction(negate(proposition), options, nullptr, proof, true) == Budget::YES;
+}
+
+bool isValid(const PropositionSP& proposition, std::ostream& proof, const Options& options) {
+	proof << "Proof by refutation:\n";
+	return checkContradiction(negate(proposition), options, nullptr, &proof) == Budget::YES;
+}
+
+Budget::Answer isValid(const PropositionSP& proposition, Budget& budget, std::string* proof,
+	                   const Options& options) {
+	return checkContradiction(negate(proposition), options, &budget, proof, true);
+}
+
+bool isContradiction(const PropositionSP& proposition, std::string* proof, const Options& options) {
+	return checkContradiction(proposition, options, nullptr, proof, false) == Budget::YES;
+}
+
+bool isContradiction(const PropositionSP& proposition, std::ostream& proof, const Options& options) {
+	return checkContradiction(proposition, options, nullptr, &proof) == Budget::YES;
+}
+
+Budget::Answer isContradiction(const PropositionSP& proposition, Budget& budget, std::string* proof,
+	                           const Options& options) {
+	return checkContradiction(proposition, options, &budget, proof, false);
+}
+
+bool isCnfContradiction(const Cnf& clauses, Budget* budget, bool* interrupted, const Options& options) {
+	Cnf squeezedClauses = clauses;
+	if (interrupted)
+		*interrupted = false;
+	Stats stats;
+	PhaseTimer timer(options.stats != nullptr);
+	const bool result = resolveCnf(squeezedClauses, 0, options, stats, budget, interrupted);
+	timer.stop(stats.saturationTime);
+	if (options.stats)
+		*options.stats = stats;
 	return result;
 }
 
@@ -1,11 +1,94 @@
 #pragma once
 
 #include "Proposition.hpp"
+#include "NormalForm.hpp"
+#include "Budget.hpp"
 
 #include <string>
+#include <ostream>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
 
 namespace Resolution {
-	bool isValid(const PropositionSP& proposition, std::string* proof = nullptr);
-	bool isContradiction(const PropositionSP& proposition, std::string* proof = nullptr);
+	const int MAX_VARIABLE_COUNT = 512; // distinct variables, wider clauses cost more per operation, not for ZRES
+
+	// Counters of one call, the timings are measured only when the statistics are requested
+	struct Stats {
+		uint64_t givenClauses; // iterations of the saturation loop
+		uint64_t eliminatedVariables; // Davis-Putnam
+		uint64_t resolvents; // generated, tautologies included
+		uint64_t tautologies;
+		uint64_t forwardSubsumed; // new clauses subsumed by a processed clause
+		uint64_t backwardSubsumed; // processed clauses removed by a new clause
+		uint64_t strengthened; // clauses shortened by units or replaced by a resolvent inside them
+		uint64_t pureLiteralClauses; // input clauses dropped for a pure literal
+		size_t peakUnprocessed;
+		size_t peakProcessed;
+		size_t zbddNodes; // ZRES
+		std::chrono::nanoseconds cnfTime;
+		std::chrono::nanoseconds simplificationTime; // of the input clauses
+		std::chrono::nanoseconds saturationTime; // the saturation phases below included
+		std::chrono::nanoseconds selectionTime; // of the given clause or the variable to eliminate
+		std::chrono::nanoseconds subsumptionTime;
+		std::chrono::nanoseconds generationTime;
+		std::chrono::nanoseconds proofTime;
+
+		Stats() : givenClauses(0), eliminatedVariables(0), resolvents(0), tautologies(0), forwardSubsumed(0),
+		          backwardSubsumed(0), strengthened(0), pureLiteralClauses(0), peakUnprocessed(0), peakProcessed(0),
+		          zbddNodes(0), cnfTime(0), simplificationTime(0), saturationTime(0), selectionTime(0),
+		          subsumptionTime(0), generationTime(0), proofTime(0) {}
+	};
+
+	struct Options {
+		// Refutationally complete restrictions of the saturation and the Davis-Putnam procedure:
+		// SET_OF_SUPPORT - every resolvent descends from the negated goal, the conclusion of
+		//                  a top-level implication (the whole input otherwise)
+		// ORDERED - both parents are resolved on their largest variable id
+		// POSITIVE_HYPERRESOLUTION - all negative literals of a clause are resolved with positive clauses at once
+		// NEGATIVE_HYPERRESOLUTION - the same with the signs swapped
+		// DAVIS_PUTNAM - no saturation, the variables are eliminated one by one, the one with the fewest
+		//                resolvent candidates first, only the current clause set is kept
+		// ZRES - DAVIS_PUTNAM on the clause set stored as a zero-suppressed BDD, compressed sets of
+		//        any number of variables, the proof has no resolution steps
+		enum Strategy { SATURATION, SET_OF_SUPPORT, ORDERED, POSITIVE_HYPERRESOLUTION, NEGATIVE_HYPERRESOLUTION,
+		                DAVIS_PUTNAM, ZRES };
+		Strategy strategy;
+		// Order of the given clauses:
+		// MASK_ORDER - by the literal masks, the variables with larger ids last
+		// WEIGHT - fewest literals first, then the oldest
+		// AGE_WEIGHT - every fifth clause the oldest one, otherwise by weight
+		// GOAL_DISTANCE - by weight plus the resolution steps from the negated goal
+		enum Selection { MASK_ORDER, WEIGHT, AGE_WEIGHT, GOAL_DISTANCE };
+		Selection selection;
+		// Threads generating the resolvents of a given clause, 0 means one per hardware thread.
+		// The derivation and the proof are the same for any thread count.
+		unsigned threadCount;
+		// Unit propagation and pure literal elimination on the input, strengthening by units
+		// and by resolvents inside a parent during the saturation
+		bool simplification;
+		// Filled in by each call when set
+		Stats* stats;
+
+		Options() : strategy(SATURATION), selection(MASK_ORDER), threadCount(1), simplification(true),
+		            stats(nullptr) {}
+	};
+
+	bool isValid(const PropositionSP& proposition, std::string* proof = nullptr, const Options& options = Options());
+	bool isContradiction(const PropositionSP& proposition, std::string* proof = nullptr,
+	                     const Options& options = Options());
+	// The proof is written as it is rendered
+	bool isValid(const PropositionSP& proposition, std::ostream& proof, const Options& options = Options());
+	bool isContradiction(const PropositionSP& proposition, std::ostream& proof, const Options& options = Options());
+	// A processed clause is a step
+	Budget::Answer isValid(const PropositionSP& proposition, Budget& budget, std::string* proof = nullptr,
+	                       const Options& options = Options());
+	Budget::Answer isContradiction(const PropositionSP& proposition, Budget& budget, std::string* proof = nullptr,
+	                               const Options& options = Options());
+
+	// No proof. If the budget is exceeded during saturation,
+	// *interrupted is set and the result (false) is not definitive.
+	bool isCnfContradiction(const Cnf& clauses, Budget* budget = nullptr, bool* interrupted = nullptr,
+	                        const Options& options = Options());
 
 } // namespace Resolution
@@ -0,0 +1,38 @@
+#include "SatSolver.hpp"
+
+#include <algorithm>
+
+void SatSolver::addCnf(Cnf&& cnf) {
+	for (auto& clause : cnf)
+		addClause(clause);
+	cnf.clear();
+}
+
+bool SatSolver::squeezeAssumptions(const std::vector<Literal>& assumptions, const std::vector<VariableId>& originalIds,
+                                   std::vector<Literal>& squeezedAssumptions) {
+	squeezedAssumptions.clear();
+	freeAssumptions.clear();
+	for (auto& assumption : assumptions) {
+		auto it = std::lower_bound(originalIds.begin(), originalIds.end(), assumption.varId);
+		if (it != originalIds.end() && *it == assumption.varId)
+			squeezedAssumptions.push_back(Literal(static_cast<VariableId>(it - originalIds.begin()), assumption.neg));
+		else
+			freeAssumptions.push_back(assumption);
+	}
+	for (auto* literals : { &squeezedAssumptions, &freeAssumptions }) {
+		std::sort(literals->begin(), literals->end(), [](const Literal& lhs, const Literal& rhs) {
+			return lhs.varId < rhs.varId || (lhs.varId == rhs.varId && lhs.neg < rhs.neg);
+		});
+		for (size_t i = 1; i < literals->size(); i++)
+			if ((*literals)[i - 1].varId == (*literals)[i].varId && (*literals)[i - 1].neg != (*literals)[i].neg)
+				return false;
+	}
+	return true;
+}
+
+bool SatSolver::getFreeValue(VariableId id) const {
+	for (auto& assumption : freeAssumptions)
+		if (assumption.varId == id)
+			return !assumption.neg;
+	return false;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "NormalForm.hpp"
+#include "Budget.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/* Common interface of the CNF SAT engines. Variable ids are those of the added
+ * clauses, they do not need to be dense. Solvers which cannot prove
+ * unsatisfiability answer UNKNOWN instead of NO.
+ */
+class SatSolver {
+public:
+	struct Stats {
+		uint64_t decisions;
+		uint64_t propagations;
+		uint64_t conflicts;
+		uint64_t flips; // local search
+
+		Stats() : decisions(0), propagations(0), conflicts(0), flips(0) {}
+	};
+
+	virtual ~SatSolver() = default;
+
+	virtual void addClause(const Clause& clause) = 0;
+	virtual void addCnf(Cnf&& cnf); // the clauses are moved, not copied, where the solver allows it
+	virtual Budget::Answer solve(const std::vector<Literal>& assumptions = {}) = 0;
+	virtual bool getValue(VariableId id) const = 0; // value in the last model, else the assumed value or false
+	virtual void setBudget(Budget* budget) = 0;
+	virtual Stats getStats() const = 0;
+	virtual std::string getName() const = 0;
+
+protected:
+	std::vector<Literal> freeAssumptions; // of the last solve() on ids no clause contains, original ids
+
+	// Squeezed ids for the assumptions on originalIds, the others become freeAssumptions; false if contradictory
+	bool squeezeAssumptions(const std::vector<Literal>& assumptions, const std::vector<VariableId>& originalIds,
+	                        std::vector<Literal>& squeezedAssumptions);
+	bool getFreeValue(VariableId id) const; // the assumed value, false if not assumed
+};
@@ -0,0 +1,109 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace {
+	thread_local const ThreadPool* currentPool = nullptr;
+	thread_local unsigned currentWorker = 0;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount) :
+	pendingCount(0), busyCount(0), nextQueue(0), stopping(false) {
+	if (threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	for (unsigned i = 0; i < threadCount; i++)
+		queues.push_back(std::make_unique<WorkQueue>());
+	for (unsigned i = 0; i < threadCount; i++)
+		workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	taskAvailable.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+	unsigned index;
+	if (currentPool == this) {
+		index = currentWorker;
+	}
+	else {
+		std::lock_guard<std::mutex> lock(mutex);
+		index = nextQueue++ % queues.size();
+	}
+	{
+		std::lock_guard<std::mutex> lock(queues[index]->mutex);
+		queues[index]->tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pendingCount++;
+	}
+	taskAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	tasksFinished.wait(lock, [this] { return pendingCount == 0 && busyCount == 0; });
+}
+
+unsigned ThreadPool::getThreadCount() const {
+	return static_cast<unsigned>(workers.size());
+}
+
+size_t ThreadPool::getPendingCount() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return pendingCount;
+}
+
+bool ThreadPool::takeTask(unsigned index, std::function<void()>& task) {
+	{
+		auto& own = *queues[index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			return true;
+		}
+	}
+	for (size_t i = 1; i < queues.size(); i++) {
+		auto& victim = *queues[(index + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+	currentPool = this;
+	currentWorker = index;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		taskAvailable.wait(lock, [this] { return stopping || pendingCount > 0; });
+		if (pendingCount == 0)
+			return; // stopping
+		lock.unlock();
+		std::function<void()> task;
+		bool taken = takeTask(index, task);
+		lock.lock();
+		if (!taken)
+			continue; // the task was taken by another worker in the meantime
+		pendingCount--;
+		busyCount++;
+		lock.unlock();
+		task();
+		lock.lock();
+		busyCount--;
+		if (pendingCount == 0 && busyCount == 0)
+			tasksFinished.notify_all();
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/* Work-stealing thread pool. Every worker owns a deque: tasks submitted from
+ * inside a task go to the submitting worker's deque and are taken back LIFO,
+ * while idle workers steal the oldest tasks from the other deques.
+ */
+class ThreadPool {
+public:
+	explicit ThreadPool(unsigned threadCount = 0); // 0 means one thread per hardware thread
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void submit(std::function<void()> task);
+	void wait(); // blocks until all submitted tasks are finished
+	unsigned getThreadCount() const;
+	size_t getPendingCount() const; // submitted tasks which have not started yet
+
+private:
+	struct WorkQueue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::thread> workers;
+	std::vector<std::unique_ptr<WorkQueue>> queues;
+	mutable std::mutex mutex;
+	std::condition_variable taskAvailable;
+	std::condition_variable tasksFinished;
+	size_t pendingCount;
+	unsigned busyCount;
+	unsigned nextQueue;
+	bool stopping;
+
+	void workerLoop(unsigned index);
+	bool takeTask(unsigned index, std::function<void()>& task);
+};
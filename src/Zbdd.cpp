@@ -0,0 +1,286 @@
+#include "Zbdd.hpp"
+#include "Budget.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+Zbdd::Zbdd(Budget* budget) : budget(budget), interrupted(false) {
+	const int TERMINAL = std::numeric_limits<int>::max();
+	nodes.push_back({ TERMINAL, EMPTY, EMPTY });
+	nodes.push_back({ TERMINAL, BASE, BASE });
+}
+
+size_t Zbdd::NodeHash::operator()(const NodeData& node) const {
+	uint64_t key = (static_cast<uint64_t>(node.low) << 32 | node.high) * 0x9E3779B97F4A7C15ull;
+	return static_cast<size_t>(key ^ (key >> 29) ^ static_cast<uint64_t>(node.element));
+}
+
+bool Zbdd::NodeEqual::operator()(const NodeData& lhs, const NodeData& rhs) const {
+	return lhs.element == rhs.element && lhs.low == rhs.low && lhs.high == rhs.high;
+}
+
+Zbdd::Node Zbdd::getNode(int element, Node low, Node high) {
+	if (high == EMPTY)
+		return low; // zero-suppression
+	const NodeData node{ element, low, high };
+	auto it = uniqueTable.find(node);
+	if (it != uniqueTable.end())
+		return it->second;
+	const Node result = static_cast<Node>(nodes.size());
+	if (budget && result % BUDGET_CHECK_INTERVAL == 0 && budget->isExceeded(0, getMemoryUsage()))
+		interrupted = true;
+	nodes.push_back(node);
+	uniqueTable.emplace(node, result);
+	return result;
+}
+
+int Zbdd::getElement(Node f) const {
+	return nodes[f].element;
+}
+
+uint64_t Zbdd::getKey(uint32_t lhs, uint32_t rhs) {
+	return static_cast<uint64_t>(lhs) << 32 | rhs;
+}
+
+Zbdd::Node Zbdd::makeSet(std::vector<int> elements) {
+	std::sort(elements.begin(), elements.end());
+	elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+	Node result = BASE;
+	for (auto it = elements.rbegin(); it != elements.rend(); ++it)
+		result = getNode(*it, EMPTY, result);
+	return result;
+}
+
+Zbdd::Node Zbdd::unite(Node f, Node g) {
+	if (f == EMPTY || f == g)
+		return g;
+	if (g == EMPTY)
+		return f;
+	if (f > g)
+		std::swap(f, g);
+	if (interrupted)
+		return EMPTY;
+	const uint64_t key = getKey(f, g);
+	auto it = cache[UNION].find(key);
+	if (it != cache[UNION].end())
+		return static_cast<Node>(it->second);
+	const int x = std::min(getElement(f), getElement(g));
+	const Node f0 = getElement(f) == x ? nodes[f].low : f;
+	const Node f1 = getElement(f) == x ? nodes[f].high : EMPTY;
+	const Node g0 = getElement(g) == x ? nodes[g].low : g;
+	const Node g1 = getElement(g) == x ? nodes[g].high : EMPTY;
+	const Node result = getNode(x, unite(f0, g0), unite(f1, g1));
+	cache[UNION].emplace(key, result);
+	return result;
+}
+
+Zbdd::Node Zbdd::subtract(Node f, Node g) {
+	if (f == EMPTY || f == g)
+		return EMPTY;
+	if (g == EMPTY)
+		return f;
+	if (interrupted)
+		return EMPTY;
+	const uint64_t key = getKey(f, g);
+	auto it = cache[DIFFERENCE].find(key);
+	if (it != cache[DIFFERENCE].end())
+		return static_cast<Node>(it->second);
+	Node result;
+	if (getElement(f) < getElement(g))
+		result = getNode(getElement(f), subtract(nodes[f].low, g), nodes[f].high);
+	else if (getElement(f) > getElement(g))
+		result = subtract(f, nodes[g].low);
+	else
+		result = getNode(getElement(f), subtract(nodes[f].low, nodes[g].low),
+		                 subtract(nodes[f].high, nodes[g].high));
+	cache[DIFFERENCE].emplace(key, result);
+	return result;
+}
+
+Zbdd::Node Zbdd::subset0(Node f, int element) {
+	if (getElement(f) > element)
+		return f;
+	if (getElement(f) == element)
+		return nodes[f].low;
+	if (interrupted)
+		return EMPTY;
+	const uint64_t key = getKey(f, static_cast<uint32_t>(element));
+	auto it = cache[SUBSET0].find(key);
+	if (it != cache[SUBSET0].end())
+		return static_cast<Node>(it->second);
+	const Node result = getNode(getElement(f), subset0(nodes[f].low, element), subset0(nodes[f].high, element));
+	cache[SUBSET0].emplace(key, result);
+	return result;
+}
+
+Zbdd::Node Zbdd::subset1(Node f, int element) {
+	if (getElement(f) > element)
+		return EMPTY;
+	if (getElement(f) == element)
+		return nodes[f].high;
+	if (interrupted)
+		return EMPTY;
+	const uint64_t key = getKey(f, static_cast<uint32_t>(element));
+	auto it = cache[SUBSET1].find(key);
+	if (it != cache[SUBSET1].end())
+		return static_cast<Node>(it->second);
+	const Node result = getNode(getElement(f), subset1(nodes[f].low, element), subset1(nodes[f].high, element));
+	cache[SUBSET1].emplace(key, result);
+	return result;
+}
+
+Zbdd::Node Zbdd::product(Node f, Node g) {
+	if (f == EMPTY || g == EMPTY)
+		return EMPTY;
+	if (f == BASE)
+		return g;
+	if (g == BASE)
+		return f;
+	if (f > g)
+		std::swap(f, g);
+	if (interrupted)
+		return EMPTY;
+	const uint64_t key = getKey(f, g);
+	auto it = cache[PRODUCT].find(key);
+	if (it != cache[PRODUCT].end())
+		return static_cast<Node>(it->second);
+	const int x = std::min(getElement(f), getElement(g));
+	const Node f0 = getElement(f) == x ? nodes[f].low : f;
+	const Node f1 = getElement(f) == x ? nodes[f].high : EMPTY;
+	const Node g0 = getElement(g) == x ? nodes[g].low : g;
+	const Node g1 = getElement(g) == x ? nodes[g].high : EMPTY;
+	const Node high = unite(unite(product(f1, g1), product(f1, g0)), product(f0, g1));
+	const Node result = getNode(x, product(f0, g0), high);
+	cache[PRODUCT].emplace(key, result);
+	return result;
+}
+
+Zbdd::Node Zbdd::removeSupersets(Node f, Node g) {
+	if (f == EMPTY || g == BASE || f == g)
+		return EMPTY;
+	if (g == EMPTY)
+		return f;
+	if (f == BASE)
+		return containsEmptySet(g) ? EMPTY : BASE;
+	if (interrupted)
+		return EMPTY;
+	const uint64_t key = getKey(f, g);
+	auto it = cache[SUPERSETS].find(key);
+	if (it != cache[SUPERSETS].end())
+		return static_cast<Node>(it->second);
+	Node result;
+	if (getElement(f) > getElement(g)) // the sets of g with the element are no subsets
+		result = removeSupersets(f, nodes[g].low);
+	else {
+		const int x = getElement(f);
+		const Node g0 = getElement(g) == x ? nodes[g].low : g;
+		const Node g1 = getElement(g) == x ? nodes[g].high : EMPTY;
+		// a set with x is subsumed by the sets of g with or without x
+		const Node high = removeSupersets(removeSupersets(nodes[f].high, g0), g1);
+		result = getNode(x, removeSupersets(nodes[f].low, g0), high);
+	}
+	cache[SUPERSETS].emplace(key, result);
+	return result;
+}
+
+Zbdd::Node Zbdd::minimize(Node f) {
+	if (f == EMPTY || f == BASE)
+		return f;
+	if (interrupted)
+		return EMPTY;
+	auto it = cache[MINIMIZE].find(f);
+	if (it != cache[MINIMIZE].end())
+		return static_cast<Node>(it->second);
+	const Node low = minimize(nodes[f].low);
+	const Node result = getNode(getElement(f), low, removeSupersets(minimize(nodes[f].high), low));
+	cache[MINIMIZE].emplace(f, result);
+	return result;
+}
+
+Zbdd::Node Zbdd::removeComplementary(Node f) {
+	if (f == EMPTY || f == BASE)
+		return f;
+	if (interrupted)
+		return EMPTY;
+	auto it = cache[COMPLEMENTARY].find(f);
+	if (it != cache[COMPLEMENTARY].end())
+		return static_cast<Node>(it->second);
+	const int x = getElement(f);
+	Node high = nodes[f].high;
+	if (x % 2 == 0)
+		high = subset0(high, x + 1);
+	const Node result = getNode(x, removeComplementary(nodes[f].low), removeComplementary(high));
+	cache[COMPLEMENTARY].emplace(f, result);
+	return result;
+}
+
+bool Zbdd::containsEmptySet(Node f) const {
+	while (f != EMPTY && f != BASE)
+		f = nodes[f].low;
+	return f == BASE;
+}
+
+uint64_t Zbdd::count(Node f) {
+	if (f == EMPTY || f == BASE)
+		return f;
+	auto it = cache[COUNT].find(f);
+	if (it != cache[COUNT].end())
+		return it->second;
+	const uint64_t low = count(nodes[f].low);
+	const uint64_t high = count(nodes[f].high);
+	const uint64_t result = low > std::numeric_limits<uint64_t>::max() - high ?
+		std::numeric_limits<uint64_t>::max() : low + high;
+	cache[COUNT].emplace(f, result);
+	return result;
+}
+
+void Zbdd::countElements(Node f, std::vector<uint64_t>& counts) {
+	// a node is reached by paths[node] paths from f, each continued by count(high) sets with the element;
+	// the children are created before their parents, so a decreasing order of the reachable nodes is topological
+	const uint64_t MAX = std::numeric_limits<uint64_t>::max();
+	std::vector<Node> reachable;
+	std::unordered_map<Node, uint64_t> paths;
+	std::vector<Node> stack{ f };
+	while (!stack.empty()) {
+		const Node node = stack.back();
+		stack.pop_back();
+		if (node == EMPTY || node == BASE || !paths.emplace(node, 0).second)
+			continue;
+		reachable.push_back(node);
+		stack.push_back(nodes[node].low);
+		stack.push_back(nodes[node].high);
+	}
+	std::sort(reachable.begin(), reachable.end(), std::greater<Node>());
+	if (!reachable.empty())
+		paths[f] = 1;
+	for (Node node : reachable) {
+		const uint64_t pathCount = paths[node];
+		const uint64_t setCount = count(nodes[node].high);
+		const int element = getElement(node);
+		if (static_cast<size_t>(element) >= counts.size())
+			counts.resize(element + 1);
+		const uint64_t product = setCount && pathCount > MAX / setCount ? MAX : pathCount * setCount;
+		counts[element] = counts[element] > MAX - product ? MAX : counts[element] + product;
+		for (Node child : { nodes[node].low, nodes[node].high })
+			if (child != EMPTY && child != BASE)
+				paths[child] = paths[child] > MAX - pathCount ? MAX : paths[child] + pathCount;
+	}
+}
+
+size_t Zbdd::getNodeCount() const {
+	return nodes.size();
+}
+
+size_t Zbdd::getMemoryUsage() const {
+	return nodes.size() * NODE_MEMORY;
+}
+
+bool Zbdd::isInterrupted() const {
+	return interrupted;
+}
+
+void Zbdd::clearCache() {
+	for (auto& operationCache : cache)
+		operationCache.clear();
+}
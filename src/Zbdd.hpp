@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+class Budget;
+
+/* Zero-suppressed binary decision diagrams over families of sets of non-negative
+ * integers. The smallest element is tested at the root and a node whose high edge
+ * leads to the empty family is never created, so sparse families like clause sets
+ * share their common parts. Nodes are hash-consed in a unique table and live until
+ * the manager is destroyed, the operations are memoized in a computed cache which
+ * may be cleared at any time. With a budget, once it is exceeded during node creation
+ * all operations return EMPTY and the results are meaningless.
+ */
+class Zbdd {
+public:
+	typedef uint32_t Node;
+	static const Node EMPTY = 0; // no set
+	static const Node BASE = 1; // only the empty set
+
+	Zbdd(Budget* budget = nullptr);
+	~Zbdd() = default;
+	Zbdd(const Zbdd&) = delete;
+	Zbdd& operator=(const Zbdd&) = delete;
+
+	Node makeSet(std::vector<int> elements); // the family of one set
+	Node unite(Node f, Node g);
+	Node subtract(Node f, Node g);
+	Node subset0(Node f, int element); // sets without the element
+	Node subset1(Node f, int element); // sets with the element, the element removed
+	Node product(Node f, Node g); // unions of a set of f with a set of g
+	Node removeSupersets(Node f, Node g); // sets of f which contain no set of g
+	Node minimize(Node f); // sets of f which contain no other set of f
+	Node removeComplementary(Node f); // sets containing both 2 * i and 2 * i + 1
+
+	bool containsEmptySet(Node f) const;
+	uint64_t count(Node f); // number of sets, saturated at the maximum
+	void countElements(Node f, std::vector<uint64_t>& counts); // element -> number of sets containing it
+	size_t getNodeCount() const;
+	size_t getMemoryUsage() const; // estimate
+	bool isInterrupted() const;
+	void clearCache();
+
+private:
+	static const uint32_t BUDGET_CHECK_INTERVAL = 4096; // created nodes
+	// rough estimate per node: the node, its unique table entry and a few cache entries
+	static const size_t NODE_MEMORY = 96;
+
+	enum Operation { UNION, DIFFERENCE, SUBSET0, SUBSET1, PRODUCT, SUPERSETS, MINIMIZE, COMPLEMENTARY, COUNT,
+	                 OPERATION_COUNT };
+
+	struct NodeData {
+		int element; // the maximum for the terminals
+		Node low; // sets without the element
+		Node high; // sets with the element, the element removed
+	};
+
+	struct NodeHash {
+		size_t operator()(const NodeData& node) const;
+	};
+
+	struct NodeEqual {
+		bool operator()(const NodeData& lhs, const NodeData& rhs) const;
+	};
+
+	Budget* budget;
+	bool interrupted;
+	std::vector<NodeData> nodes;
+	std::unordered_map<NodeData, Node, NodeHash, NodeEqual> uniqueTable;
+	std::unordered_map<uint64_t, uint64_t> cache[OPERATION_COUNT]; // operands -> result
+
+	Node getNode(int element, Node low, Node high);
+	int getElement(Node f) const;
+	static uint64_t getKey(uint32_t lhs, uint32_t rhs);
+};
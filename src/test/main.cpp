@@ -9,7 +9,13 @@
 #include "../NaturalDeduction.hpp"
 #include "../NormalForm.hpp"
 #include "../CnfSat.hpp"
+#include "../Portfolio.hpp"
+#include "../CubeAndConquer.hpp"
+#include "../ModelCounter.hpp"
+#include "../DratProof.hpp"
 #include "../LogicCircuit.hpp"
+#include "../Bdd.hpp"
+#include "../Fingerprint.hpp"
 
 #include "minisat/core/Solver.h"
 #include <cassert>
@@ -17,6 +23,10 @@
 #include <iomanip>
 #include <fstream>
 #include <functional>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
 
 using namespace std;
 
@@ -80,6 +90,202 @@ void testResolutionGen(int literalNum, int clauseNum, int variableNum, ofstream&
 	testResolution(converter.toString(prop), checker.isValid(prop), logFile);
 }
 
+void testResolutionChain(int variableNum, bool contradiction) {
+	// a -> b -> ... over more variables than fit into one word
+	Cnf clauses;
+	clauses.push_back({ Literal(0, false) });
+	for (VariableId id = 0; id + 1 < variableNum; id++)
+		clauses.push_back({ Literal(id, true), Literal(id + 1, false) });
+	if (contradiction)
+		clauses.push_back({ Literal(variableNum - 1, true) });
+	bool pass = Resolution::isCnfContradiction(clauses) == contradiction;
+	printTestItem("Resolution", pass, "implication chain of " + to_string(variableNum) + " variables");
+}
+
+void testResolutionThreads(int clauseNum, int variableNum, unsigned threadCount, unsigned seed) {
+	// the proof without the elapsed time does not depend on the thread count
+	Cnf clauses;
+	std::mt19937 gen(seed);
+	generateCnf(clauses, 3, clauseNum, variableNum, gen);
+	auto prop = cnfToProposition(clauses);
+	string proofs[2];
+	double seconds[2];
+	bool results[2];
+	for (int i = 0; i < 2; i++) {
+		Resolution::Options options;
+		options.threadCount = i == 0 ? 1 : threadCount;
+		auto start = std::chrono::high_resolution_clock::now();
+		results[i] = Resolution::isContradiction(prop, &proofs[i], options);
+		auto end = std::chrono::high_resolution_clock::now();
+		seconds[i] = std::chrono::duration<double>(end - start).count();
+		proofs[i].erase(proofs[i].rfind("Elapsed time"));
+	}
+	bool pass = results[0] == results[1] && proofs[0] == proofs[1];
+	string addInfo = "3-SAT " + to_string(clauseNum) + "/" + to_string(variableNum) + ", threads: " +
+		to_string(threadCount) + ", speedup: " + to_string(seconds[0] / std::max(seconds[1], 1e-6));
+	printTestItem("Resolution threads", pass, addInfo);
+}
+
+void testResolutionStream(int clauseNum, int variableNum, unsigned seed) {
+	// the streamed proof is the same as the string one
+	Cnf clauses;
+	std::mt19937 gen(seed);
+	generateCnf(clauses, 3, clauseNum, variableNum, gen);
+	auto prop = std::make_shared<UnaryOperator>(cnfToProposition(clauses), UnaryOperator::NOT);
+	string proofString;
+	bool valid = Resolution::isValid(prop, &proofString);
+	std::ostringstream proofStream;
+	bool pass = Resolution::isValid(prop, proofStream) == valid;
+	string streamed = proofStream.str();
+	proofString.erase(proofString.rfind("Elapsed time"));
+	streamed.erase(streamed.rfind("Elapsed time"));
+	pass = pass && valid && proofString == streamed;
+	size_t lineCount = std::count(streamed.begin(), streamed.end(), '\n');
+	printTestItem("Resolution stream", pass, "proof lines: " + to_string(lineCount));
+}
+
+void testResolutionStrategy(Resolution::Options::Strategy strategy, const string& name) {
+	// generated 3-SAT instances refuted directly and as premises -> negated conclusion
+	const int VARIABLE_NUM = 22;
+	bool pass = true;
+	double seconds = 0;
+	for (int ratio = 2; ratio <= 8; ratio++) {
+		Cnf clauses;
+		std::mt19937 gen(5734579 + ratio);
+		generateCnf(clauses, 3, VARIABLE_NUM * ratio, VARIABLE_NUM, gen);
+		const size_t half = clauses.size() / 2;
+		Cnf premises(clauses.begin(), clauses.begin() + half);
+		Cnf conclusion(clauses.begin() + half, clauses.end());
+		PropositionSP props[2] = {
+			std::make_shared<UnaryOperator>(cnfToProposition(clauses), UnaryOperator::NOT),
+			std::make_shared<BinaryOperator>(cnfToProposition(premises), BinaryOperator::IMP,
+				std::make_shared<UnaryOperator>(cnfToProposition(conclusion), UnaryOperator::NOT))
+		};
+		for (auto& prop : props) {
+			Resolution::Options options;
+			options.strategy = strategy;
+			NaiveModelChecker checker;
+			bool valid = checker.isValid(prop);
+			auto start = std::chrono::high_resolution_clock::now();
+			pass = pass && Resolution::isValid(prop, nullptr, options) == valid;
+			auto end = std::chrono::high_resolution_clock::now();
+			seconds += std::chrono::duration<double>(end - start).count();
+		}
+	}
+	printTestItem("Resolution strategy", pass, name + ", elapsed: " + to_string(seconds) + "s");
+}
+
+void testResolutionSelection(Resolution::Options::Selection selection, const string& name) {
+	// the same instances as the strategy test, given clauses are read from the proof output
+	const int VARIABLE_NUM = 22;
+	bool pass = true;
+	uint64_t givenClauseCount = 0;
+	for (int ratio = 2; ratio <= 8; ratio++) {
+		Cnf clauses;
+		std::mt19937 gen(5734579 + ratio);
+		generateCnf(clauses, 3, VARIABLE_NUM * ratio, VARIABLE_NUM, gen);
+		const size_t half = clauses.size() / 2;
+		Cnf premises(clauses.begin(), clauses.begin() + half);
+		Cnf conclusion(clauses.begin() + half, clauses.end());
+		PropositionSP props[2] = {
+			std::make_shared<UnaryOperator>(cnfToProposition(clauses), UnaryOperator::NOT),
+			std::make_shared<BinaryOperator>(cnfToProposition(premises), BinaryOperator::IMP,
+				std::make_shared<UnaryOperator>(cnfToProposition(conclusion), UnaryOperator::NOT))
+		};
+		for (auto& prop : props) {
+			Resolution::Options options;
+			options.selection = selection;
+			NaiveModelChecker checker;
+			std::ostringstream proof;
+			pass = pass && Resolution::isValid(prop, proof, options) == checker.isValid(prop);
+			const string output = proof.str();
+			const size_t pos = output.find("Given clauses: ");
+			pass = pass && pos != string::npos;
+			if (pos != string::npos)
+				givenClauseCount += std::stoull(output.substr(pos + 15));
+		}
+	}
+	printTestItem("Resolution selection", pass, name + ", given clauses: " + to_string(givenClauseCount));
+}
+
+void testResolutionStats(int clauseNum, int variableNum, unsigned seed) {
+	// the counters do not depend on the thread count and the phases fit into the saturation
+	Cnf clauses;
+	std::mt19937 gen(seed);
+	generateCnf(clauses, 3, clauseNum, variableNum, gen);
+	auto prop = std::make_shared<UnaryOperator>(cnfToProposition(clauses), UnaryOperator::NOT);
+	Resolution::Stats stats[2];
+	std::ostringstream proof;
+	Resolution::Options options;
+	options.stats = &stats[0];
+	bool pass = Resolution::isValid(prop, proof, options);
+	options.stats = &stats[1];
+	options.threadCount = 4;
+	pass = Resolution::isValid(prop, nullptr, options) && pass;
+	for (int i = 0; i < 2; i++)
+		pass = pass && stats[i].tautologies + stats[i].forwardSubsumed <= stats[i].resolvents + stats[i].givenClauses &&
+			stats[i].selectionTime + stats[i].subsumptionTime + stats[i].generationTime <= stats[i].saturationTime &&
+			stats[i].peakUnprocessed > 0 && stats[i].peakProcessed > 0;
+	pass = pass && stats[0].givenClauses == stats[1].givenClauses && stats[0].resolvents == stats[1].resolvents &&
+		stats[0].tautologies == stats[1].tautologies && stats[0].forwardSubsumed == stats[1].forwardSubsumed &&
+		stats[0].backwardSubsumed == stats[1].backwardSubsumed && stats[0].proofTime.count() > 0 &&
+		proof.str().find("Given clauses: " + to_string(stats[0].givenClauses) + " ") != string::npos;
+	printTestItem("Resolution stats", pass, "given: " + to_string(stats[0].givenClauses) +
+		", resolvents: " + to_string(stats[0].resolvents) + ", tautologies: " + to_string(stats[0].tautologies) +
+		", subsumed: " + to_string(stats[0].forwardSubsumed) + "/" + to_string(stats[0].backwardSubsumed));
+}
+
+void testResolutionSimplification(const string& proposition, bool valid) {
+	// the same answer with fewer given clauses than without simplification
+	Converter converter;
+	auto prop = converter.fromString(proposition);
+	Resolution::Stats stats[2];
+	bool pass = true;
+	for (int i = 0; i < 2; i++) {
+		Resolution::Options options;
+		options.simplification = i == 0;
+		options.stats = &stats[i];
+		pass = pass && Resolution::isValid(prop, nullptr, options) == valid;
+	}
+	pass = pass && stats[0].givenClauses <= stats[1].givenClauses;
+	printTestItem("Resolution simplification", pass, "given clauses: " + to_string(stats[0].givenClauses) +
+		" instead of " + to_string(stats[1].givenClauses) + ", " + proposition);
+}
+
+void testResolutionZres(int holeNum, int variableNum) {
+	// the pigeonhole principle and implication chains longer than the explicit clauses allow
+	Cnf clauses;
+	for (int pigeon = 0; pigeon <= holeNum; pigeon++) {
+		Clause clause;
+		for (int hole = 0; hole < holeNum; hole++)
+			clause.push_back(Literal(pigeon * holeNum + hole, false));
+		clauses.push_back(clause);
+	}
+	for (int hole = 0; hole < holeNum; hole++)
+		for (int pigeon1 = 0; pigeon1 <= holeNum; pigeon1++)
+			for (int pigeon2 = pigeon1 + 1; pigeon2 <= holeNum; pigeon2++)
+				clauses.push_back({ Literal(pigeon1 * holeNum + hole, true), Literal(pigeon2 * holeNum + hole, true) });
+	Resolution::Stats stats;
+	Resolution::Options options;
+	options.strategy = Resolution::Options::ZRES;
+	options.stats = &stats;
+	bool pass = Resolution::isCnfContradiction(clauses, nullptr, nullptr, options);
+	options.stats = nullptr;
+	clauses.pop_back();
+	pass = pass && !Resolution::isCnfContradiction(clauses, nullptr, nullptr, options);
+	for (int contradiction = 0; contradiction < 2; contradiction++) {
+		Cnf chain;
+		chain.push_back({ Literal(0, false) });
+		for (VariableId id = 0; id + 1 < variableNum; id++)
+			chain.push_back({ Literal(id, true), Literal(id + 1, false) });
+		if (contradiction)
+			chain.push_back({ Literal(variableNum - 1, true) });
+		pass = pass && Resolution::isCnfContradiction(chain, nullptr, nullptr, options) == (contradiction == 1);
+	}
+	printTestItem("Resolution ZRes", pass, to_string(holeNum) + " holes, ZBDD nodes: " + to_string(stats.zbddNodes) +
+		", chain of " + to_string(variableNum) + " variables");
+}
+
 void testForwardChaining() {
 	ForwardChainingKB kb;
 	kb.addFact(1);
@@ -164,6 +370,446 @@ void testWalkSat(const string& proposition, bool satisfiable) {
 	printTestItem("WalkSAT", pass, converter.toString(prop));
 }
 
+void testPortfolio(const string& proposition, bool satisfiable) {
+	Converter converter;
+	auto prop = converter.fromString(proposition);
+	Cnf cnf;
+	propositionToCnf(cnf, prop);
+	PortfolioSat portfolio(cnf);
+	bool result = portfolio.isSatisfiable();
+	bool pass = (satisfiable == result);
+	auto model = portfolio.getModel();
+	if (pass && result && !model.empty()) {
+		std::vector<int> variableIds;
+		prop->getVariableIds(variableIds);
+		std::sort(variableIds.begin(), variableIds.end());
+		pass = pass && model.size() == variableIds.size();
+		if (pass) {
+			std::vector<uint64_t> varValues;
+			for (int i = 0; i < model.size(); i++) {
+				if (varValues.size() < variableIds[i] + 1)
+					varValues.resize(variableIds[i] + 1);
+				varValues[variableIds[i]] = model[i];
+			}
+			pass = pass && prop->evaluate(varValues) != 0;
+		}
+	}
+	printTestItem("Portfolio", pass, "Winner: " + portfolio.getWinner());
+}
+
+void generatePigeonholeCnf(Cnf& clauses, int pigeonNum, int holeNum) {
+	clauses.clear();
+	auto varId = [holeNum](int pigeon, int hole) { return pigeon * holeNum + hole; };
+	for (int p = 0; p < pigeonNum; p++) {
+		Clause clause;
+		for (int h = 0; h < holeNum; h++)
+			clause.push_back(Literal(varId(p, h), false));
+		clauses.push_back(clause);
+	}
+	for (int h = 0; h < holeNum; h++)
+		for (int p1 = 0; p1 < pigeonNum; p1++)
+			for (int p2 = p1 + 1; p2 < pigeonNum; p2++)
+				clauses.push_back({ Literal(varId(p1, h), true), Literal(varId(p2, h), true) });
+}
+
+bool isCnfModel(const Cnf& clauses, const std::vector<bool>& model) {
+	for (auto& clause : clauses) {
+		bool trueClause = false;
+		for (auto& literal : clause)
+			if (literal.varId < model.size() && model[literal.varId] != literal.neg)
+				trueClause = true;
+		if (!trueClause)
+			return false;
+	}
+	return true;
+}
+
+void testWalkSatFlips(int clauseNum, int variableNum, unsigned seed) {
+	std::mt19937 gen(seed);
+	std::vector<bool> plantedModel;
+	Cnf clauses;
+	generatePlantedCnf(clauses, plantedModel, 3, clauseNum, variableNum, gen);
+	squeezeVariableIds(clauses);
+	WalkSat walkSat(clauses);
+	auto start = std::chrono::high_resolution_clock::now();
+	bool pass = walkSat.isSatisfiable(100000000);
+	auto end = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	uint64_t flips = walkSat.getStats().flips;
+	pass = pass && isCnfModel(clauses, walkSat.getModel());
+	string addInfo = "random 3-SAT " + to_string(clauseNum) + "/" + to_string(variableNum) +
+		", flips: " + to_string(flips) + ", flips/s: " + to_string(static_cast<uint64_t>(flips / std::max(seconds, 1e-6)));
+	printTestItem("WalkSAT", pass, addInfo);
+}
+
+void testWalkSatHeuristic(WalkSat::Heuristic heuristic, const string& name, float p) {
+	// mean flips to solution over planted random 3-SAT instances near the threshold
+	const int INSTANCE_COUNT = 10;
+	const int VARIABLE_NUM = 300;
+	const int CLAUSE_NUM = 1200;
+	const uint64_t MAX_FLIP_NUMBER = 20000000;
+	bool pass = true;
+	uint64_t flipSum = 0;
+	for (int i = 0; i < INSTANCE_COUNT; i++) {
+		std::mt19937 gen(7100 + i);
+		std::vector<bool> plantedModel;
+		Cnf clauses;
+		generatePlantedCnf(clauses, plantedModel, 3, CLAUSE_NUM, VARIABLE_NUM, gen);
+		squeezeVariableIds(clauses);
+		WalkSat walkSat(clauses);
+		walkSat.setHeuristic(heuristic);
+		pass = pass && walkSat.isSatisfiable(MAX_FLIP_NUMBER, p) && isCnfModel(clauses, walkSat.getModel());
+		flipSum += walkSat.getStats().flips;
+	}
+	string addInfo = name + ", planted 3-SAT " + to_string(CLAUSE_NUM) + "/" + to_string(VARIABLE_NUM) +
+		", mean flips: " + to_string(flipSum / INSTANCE_COUNT);
+	printTestItem("WalkSAT heuristics", pass, addInfo);
+}
+
+void testWalkSatWalkers(unsigned walkerCount, uint64_t restartFlipNumber) {
+	// the same seed gives the same model regardless of thread scheduling
+	std::mt19937 gen(7200);
+	std::vector<bool> plantedModel;
+	Cnf clauses;
+	generatePlantedCnf(clauses, plantedModel, 3, 1600, 400, gen);
+	squeezeVariableIds(clauses);
+	bool pass = true;
+	std::vector<bool> models[2];
+	uint64_t flips = 0;
+	for (int run = 0; run < 2; run++) {
+		WalkSat walkSat(clauses);
+		walkSat.setSeed(42);
+		walkSat.setWalkers(walkerCount, restartFlipNumber);
+		pass = pass && walkSat.isSatisfiable(100000000) && isCnfModel(clauses, walkSat.getModel());
+		models[run] = walkSat.getModel();
+		flips = walkSat.getStats().flips;
+	}
+	pass = pass && models[0] == models[1];
+	string addInfo = "walkers: " + to_string(walkerCount) + ", restart: " + to_string(restartFlipNumber) +
+		", flips: " + to_string(flips);
+	printTestItem("WalkSAT walkers", pass, addInfo);
+}
+
+void testCubeAndConquer(const Cnf& cnf, bool satisfiable, const string& name) {
+	Cnf clauses = cnf;
+	squeezeVariableIds(clauses);
+	CubeAndConquerSat cubeAndConquer(clauses, 4);
+	bool result = cubeAndConquer.isSatisfiable();
+	bool pass = (satisfiable == result);
+	if (pass && result)
+		pass = isCnfModel(clauses, cubeAndConquer.getModel());
+	string addInfo = name + ", cubes: " + to_string(cubeAndConquer.getCubeCount());
+	printTestItem("CubeAndConquer", pass, addInfo);
+}
+
+void testCubeAndConquerGen(int clauseNum, int variableNum, unsigned seed) {
+	Cnf clauses;
+	std::mt19937 gen(seed);
+	generateCnf(clauses, 3, clauseNum, variableNum, gen);
+	squeezeVariableIds(clauses);
+	DpllCnfSat dpll(clauses);
+	string name = "random 3-SAT " + to_string(clauseNum) + "/" + to_string(variableNum);
+	testCubeAndConquer(clauses, dpll.isSatisfiable(), name);
+}
+
+void testDratProof(const Cnf& cnf, DpllCnfSat::Branching branching, const string& name) {
+	DpllCnfSat dpll(cnf);
+	dpll.setBranching(branching);
+	std::stringstream proof;
+	DratWriter writer(proof);
+	dpll.setProofWriter(&writer);
+	bool pass = !dpll.isSatisfiable();
+	DratChecker checker(cnf);
+	pass = pass && checker.check(proof);
+	// a proof without the final lemmas must be rejected
+	DratChecker emptyProofChecker(cnf);
+	std::stringstream emptyProof(string("a\0", 2));
+	pass = pass && !emptyProofChecker.check(emptyProof);
+	string addInfo = name + ", lemmas: " + to_string(writer.getLemmaCount()) +
+		", checked: " + to_string(checker.getCheckedLemmaCount());
+	printTestItem("DratProof", pass, addInfo);
+}
+
+void testModelCounting(const string& proposition, const string& modelCount) {
+	Converter converter;
+	auto prop = converter.fromString(proposition);
+	BigInteger result = ModelCounter::countPropModels(prop);
+	bool pass = (result.toString() == modelCount);
+	printTestItem("ModelCounting", pass, result.toString() + ", " + converter.toString(prop));
+}
+
+void testModelCountingCnf(const Cnf& cnf, const vector<VariableId>& projection,
+                          const string& modelCount, const string& name) {
+	ModelCounter counter(cnf);
+	BigInteger result = projection.empty() ? counter.count() : counter.count(projection);
+	bool pass = (result.toString() == modelCount);
+	string addInfo = name + ", models: " + result.toString() +
+		", cache hits: " + to_string(counter.getCacheHitCount());
+	printTestItem("ModelCounting", pass, addInfo);
+}
+
+void testBudget() {
+	Converter converter;
+	Cnf pigeonhole;
+	generatePigeonholeCnf(pigeonhole, 9, 8);
+	bool pass = true;
+	string addInfo;
+	{
+		Budget budget;
+		budget.setStepLimit(1000);
+		DpllCnfSat dpll(pigeonhole);
+		dpll.setBudget(&budget);
+		pass = pass && !dpll.isSatisfiable() && dpll.isInterrupted() && budget.getReason() == Budget::STEPS;
+		// the steps are charged in batches of 64 nodes, the search stops at the first exceeded check
+		pass = pass && dpll.getStats().decisions <= 1000 + 64 * 72;
+	}
+	{
+		Budget budget;
+		budget.setTimeLimit(std::chrono::milliseconds(20));
+		CubeAndConquerSat cubeAndConquer(pigeonhole, 2);
+		cubeAndConquer.setBudget(&budget);
+		pass = pass && !cubeAndConquer.isSatisfiable() && cubeAndConquer.isInterrupted() &&
+			budget.getReason() == Budget::TIME;
+	}
+	{
+		Budget budget;
+		budget.stop();
+		PortfolioSat portfolio(pigeonhole, 2);
+		portfolio.setBudget(&budget);
+		portfolio.isSatisfiable();
+		pass = pass && portfolio.isInterrupted();
+	}
+	{
+		// WalkSAT wins, the stopped DPLL engines have to give up promptly
+		std::mt19937 gen(7200);
+		std::vector<bool> plantedModel;
+		Cnf clauses;
+		generatePlantedCnf(clauses, plantedModel, 3, 1200, 300, gen);
+		squeezeVariableIds(clauses);
+		PortfolioSat portfolio(clauses);
+		auto start = std::chrono::steady_clock::now();
+		pass = pass && portfolio.isSatisfiable() && portfolio.getWinner().find("WalkSAT") == 0;
+		pass = pass && std::chrono::steady_clock::now() - start < std::chrono::seconds(5);
+		pass = pass && isCnfModel(clauses, portfolio.getModel());
+	}
+	{
+		// 40 variables are too many for the naive checker, a sufficient budget gives the answer
+		string chain = "a";
+		for (int i = 1; i < 40; i++)
+			chain = "(" + chain + " | " + static_cast<char>('a' + i % 26) + (i < 26 ? "" : "1") + ")";
+		auto prop = converter.fromString(chain + " | ~a");
+		NaiveModelChecker checker;
+		Budget budget;
+		budget.setStepLimit(100);
+		pass = pass && checker.isValid(prop, budget) == Budget::UNKNOWN;
+		Budget unlimitedBudget;
+		pass = pass && checker.isValid(converter.fromString("a | b | c | d | e | f | g | ~a"),
+			unlimitedBudget) == Budget::YES;
+		pass = pass && DpllCnfSat::isPropValid(prop, unlimitedBudget) == Budget::YES;
+		addInfo = "steps: " + to_string(unlimitedBudget.getStepCount());
+	}
+	{
+		auto prop = converter.fromString("~(((a | b | c) & (d | e | f) & (g | h | i) & (j | k | l) & (m | n | o)) <-> "
+			"~((~a & ~b & ~c) | (~d & ~e & ~f) | (~g & ~h & ~i) | (~j & ~k & ~l) | (~m & ~n & ~o)))");
+		Budget budget;
+		budget.setMemoryLimit(1024);
+		pass = pass && Resolution::isContradiction(prop, budget) == Budget::UNKNOWN &&
+			budget.getReason() == Budget::MEMORY;
+		Budget parent;
+		Budget child(&parent);
+		parent.setStepLimit(10);
+		pass = pass && Resolution::isContradiction(prop, child) == Budget::UNKNOWN &&
+			child.getReason() == Budget::STEPS && parent.getStepCount() > 10;
+	}
+	{
+		NaturalDeduction nd;
+		nd.addJasInferenceRules();
+		nd.addPremise(converter.fromString("a -> b"));
+		nd.addPremise(converter.fromString("a"));
+		nd.setConclusion(converter.fromString("c"));
+		Budget budget;
+		budget.setStepLimit(50);
+		nd.setBudget(&budget);
+		int stepCount = 0;
+		while (nd.step())
+			stepCount++;
+		pass = pass && nd.isBudgetExceeded() && stepCount == 50;
+	}
+	printTestItem("Budget", pass, addInfo);
+}
+
+PropositionSP generateProposition(int depth, int variableNum, std::mt19937& gen) {
+	// all 16 binary operators, negations and a few constants
+	std::uniform_int_distribution<> kindDist(0, 9);
+	const int kind = depth == 0 ? 0 : kindDist(gen);
+	if (kind == 0 || (depth == 1 && kind < 4))
+		return std::make_shared<Variable>(std::uniform_int_distribution<>(0, variableNum - 1)(gen));
+	if (kind == 1)
+		return std::make_shared<Constant>(gen() % 2 ? Constant::TRUE : Constant::FALSE);
+	if (kind == 2)
+		return std::make_shared<UnaryOperator>(generateProposition(depth - 1, variableNum, gen), UnaryOperator::NOT);
+	auto op = static_cast<BinaryOperator::Op>(std::uniform_int_distribution<>(0, 15)(gen));
+	return std::make_shared<BinaryOperator>(generateProposition(depth - 1, variableNum, gen), op,
+		generateProposition(depth - 1, variableNum, gen));
+}
+
+void testClassification(int propositionNum, int depth, int variableNum, unsigned seed) {
+	// one call gives the answers of isValid and isContradiction for the naive checker and both SAT paths
+	std::mt19937 gen(seed);
+	NaiveModelChecker checker;
+	bool pass = true;
+	int counts[3] = {};
+	for (int i = 0; i < propositionNum; i++) {
+		auto prop = generateProposition(depth, variableNum, gen);
+		const bool valid = checker.isValid(prop);
+		const bool contradiction = checker.isContradiction(prop);
+		const Proposition::Validity expected = valid ? Proposition::VALID :
+			(contradiction ? Proposition::CONTRADICTION : Proposition::CONTINGENT);
+		Budget budget;
+		pass = pass && checker.classify(prop) == expected && checker.classify(prop, budget) == expected &&
+			DpllCnfSat::classifyProp(prop) == expected;
+		if (i % 16 == 0)
+			pass = pass && PortfolioSat::classifyProp(prop) == expected;
+		counts[expected]++;
+	}
+	Budget budget;
+	budget.stop();
+	pass = pass && checker.classify(generateProposition(depth, variableNum, gen), budget) == Proposition::UNDECIDED;
+	printTestItem("Classification", pass, "valid: " + to_string(counts[Proposition::VALID]) +
+		", contradictions: " + to_string(counts[Proposition::CONTRADICTION]) +
+		", contingent: " + to_string(counts[Proposition::CONTINGENT]));
+}
+
+void testCounterexamples(int propositionNum, int depth, int variableNum, unsigned seed) {
+	// the iterator gives each falsifying assignment once in increasing order, the first one is that of isValid
+	std::mt19937 gen(seed);
+	NaiveModelChecker checker;
+	bool pass = true;
+	uint64_t counterexampleCount = 0;
+	for (int i = 0; i < propositionNum; i++) {
+		auto prop = generateProposition(depth, variableNum, gen);
+		vector<int> variableIds;
+		prop->getVariableIds(variableIds);
+		NaiveModelChecker::Assignment first;
+		NaiveModelChecker::Assignment classified;
+		const bool valid = checker.isValid(prop, first);
+		pass = pass && (checker.classify(prop, &classified) == Proposition::VALID) == valid;
+		CounterexampleIterator iterator(prop);
+		NaiveModelChecker::Assignment counterexample;
+		uint64_t count = 0;
+		uint64_t previousModel = 0;
+		while (iterator.next(counterexample)) {
+			vector<uint64_t> varValues(variableNum);
+			uint64_t model = 0;
+			for (size_t j = 0; j < counterexample.size(); j++) {
+				varValues[counterexample[j].first] = counterexample[j].second ? ~static_cast<uint64_t>(0) : 0;
+				model |= static_cast<uint64_t>(counterexample[j].second) << j;
+			}
+			pass = pass && counterexample.size() == variableIds.size() && prop->evaluate(varValues) == 0 &&
+				(count == 0 ? counterexample == first && counterexample == classified : model > previousModel);
+			previousModel = model;
+			count++;
+		}
+		pass = pass && (count == 0) == valid &&
+			BigInteger(count) + Bdd::countPropModels(prop) == BigInteger::powerOfTwo(variableIds.size());
+		counterexampleCount += count;
+	}
+	printTestItem("Counterexamples", pass, to_string(counterexampleCount) + " counterexamples, up to " +
+		to_string(variableNum) + " variables");
+}
+
+void testBdd(int propositionNum, int depth, int variableNum, unsigned seed) {
+	// the naive checker and the component caching counter agree, reordering keeps the edges canonical
+	std::mt19937 gen(seed);
+	NaiveModelChecker checker;
+	bool pass = true;
+	Bdd bdd;
+	std::vector<PropositionSP> props;
+	std::vector<Bdd::Edge> edges;
+	std::vector<BigInteger> counts;
+	for (int i = 0; i < propositionNum; i++) {
+		auto prop = generateProposition(depth, variableNum, gen);
+		pass = pass && Bdd::classifyProp(prop) == checker.classify(prop);
+		Cnf clauses;
+		generateCnf(clauses, 3, variableNum * 3, variableNum, gen);
+		auto cnfProp = cnfToProposition(clauses);
+		pass = pass && Bdd::countPropModels(cnfProp) == ModelCounter::countPropModels(cnfProp);
+		props.push_back(prop);
+		edges.push_back(bdd.fromProposition(prop));
+	}
+	for (auto edge : edges)
+		counts.push_back(bdd.countModels(edge)); // over the variables of all propositions
+	const size_t nodeCount = bdd.getNodeCount();
+	bdd.reorder();
+	for (int i = 0; i < propositionNum; i++) {
+		const Bdd::Edge edge = bdd.fromProposition(props[i]);
+		pass = pass && edge == edges[i] && bdd.countModels(edge) == counts[i];
+		bdd.deref(edge);
+		bdd.deref(edges[i]);
+	}
+	bdd.collectGarbage();
+	pass = pass && bdd.getNodeCount() == 1;
+	printTestItem("BDD", pass, "nodes: " + to_string(nodeCount) + ", " + to_string(variableNum) + " variables");
+}
+
+void testBddSifting(int pairNum) {
+	// (a & a1) | (b & b1) | ... is exponential in the order a, b, ..., a1, b1, ... and linear interleaved
+	Converter converter;
+	vector<string> variables;
+	converter.getStringsForVariables(variables);
+	string proposition;
+	for (int i = 0; i < pairNum; i++)
+		proposition += (i == 0 ? "(" : " | (") + variables[i] + " & " + variables[i + 26] + ")";
+	auto prop = converter.fromString(proposition);
+	Bdd bdd;
+	bdd.setAutoReorder(false);
+	const Bdd::Edge edge = bdd.fromProposition(prop);
+	const size_t nodeCount = bdd.getNodeCount(edge);
+	bdd.reorder();
+	bool pass = bdd.getNodeCount(edge) == static_cast<size_t>(pairNum * 2 + 1) && bdd.countModels(edge) ==
+		BigInteger::powerOfTwo(pairNum * 2) - ModelCounter::countPropModels(std::make_shared<UnaryOperator>(prop));
+	pass = pass && Bdd::arePropsEquivalent(converter.fromString("a & (b | c | d)"),
+		converter.fromString("(a & b) | (a & c) | (a & d)"));
+	pass = pass && !Bdd::arePropsEquivalent(converter.fromString("a | (b & c)"), converter.fromString("(a | b) & c"));
+	printTestItem("BDD sifting", pass, to_string(pairNum) + " pairs, nodes: " + to_string(nodeCount) +
+		" before, " + to_string(bdd.getNodeCount(edge)) + " after");
+}
+
+void testFingerprint(int propositionNum, int depth, int variableNum, Fingerprint::Width width, unsigned seed) {
+	// buckets by fingerprint hold equivalent propositions, exact fingerprints need no confirmation
+	std::mt19937 gen(seed);
+	bool pass = true;
+	std::unordered_map<Fingerprint, vector<PropositionSP>, Fingerprint::Hash> buckets;
+	size_t functionCount = 0;
+	for (int i = 0; i < propositionNum; i++) {
+		auto prop = generateProposition(depth, variableNum, gen);
+		const Fingerprint fingerprint(prop, width);
+		auto& bucket = buckets[fingerprint];
+		bool found = false;
+		for (auto& other : bucket) {
+			const bool equivalent = Bdd::arePropsEquivalent(prop, other);
+			const Budget::Answer answer = fingerprint.isEquivalent(Fingerprint(other, width));
+			pass = pass && (answer == Budget::UNKNOWN || answer == Budget::toAnswer(equivalent));
+			found = found || equivalent;
+		}
+		if (!found) {
+			bucket.push_back(prop);
+			functionCount++;
+		}
+	}
+	for (auto& item : buckets)
+		pass = pass && (!item.first.isExact() || item.second.size() == 1);
+	Converter converter;
+	const Fingerprint commuted(converter.fromString("a & b"), width);
+	pass = pass && commuted.isEquivalent(Fingerprint(converter.fromString("b & a"), width)) == Budget::YES &&
+		Fingerprint(converter.fromString("a | ~a"), width).isEquivalent(
+			Fingerprint(converter.fromString("b -> b"), width)) == Budget::YES &&
+		Fingerprint(converter.fromString("(a & b) | (a & ~b) | c"), width).getEssentialVariableIds().size() == 2 &&
+		commuted.isEquivalent(Fingerprint(converter.fromString("a | b"), width)) == Budget::NO;
+	printTestItem("Fingerprint", pass, to_string(functionCount) + " functions in " + to_string(buckets.size()) +
+		" buckets, " + to_string(variableNum) + " variables, " + (width == Fingerprint::BITS_64 ? "64" : "512") + " bits");
+}
+
 void testCnf(const string& proposition) {
 	Converter converter;
 	auto propRef = converter.fromString(proposition);
@@ -176,32 +822,102 @@ void testCnf(const string& proposition) {
 	printTestItem("Cnf conversions", pass, converter.toString(prop));
 }
 
-LogicCircuit::BitSequence solveCnfWithMinisat(const Cnf& cnf) {
-	Minisat::Solver solver;
-	std::vector<Minisat::Var> minisatVariables;
-	for (const auto& clause : cnf) {
+class MinisatSolver : public SatSolver {
+public:
+	MinisatSolver() : budget(nullptr) {}
+
+	void addClause(const Clause& clause) override {
 		Minisat::vec<Minisat::Lit> minisatClause;
-		for (const auto& literal : clause) {
-			if (literal.varId >= minisatVariables.size())
-				minisatVariables.resize(literal.varId + 1, Minisat::var_Undef);
-			if (minisatVariables[literal.varId] == Minisat::var_Undef)
-				minisatVariables[literal.varId] = solver.newVar();
-			Minisat::Lit minisatLiteral = Minisat::mkLit(minisatVariables[literal.varId], literal.neg);
-			minisatClause.push(minisatLiteral);
-		}
+		for (const auto& literal : clause)
+			minisatClause.push(getLiteral(literal));
 		solver.addClause(minisatClause);
 	}
 
-	bool result = solver.solve();
+	Budget::Answer solve(const std::vector<Literal>& assumptions = {}) override {
+		if (budget && budget->isExceeded())
+			return Budget::UNKNOWN; // checked once, the search itself is not bounded
+		Minisat::vec<Minisat::Lit> minisatAssumptions;
+		for (const auto& literal : assumptions)
+			minisatAssumptions.push(getLiteral(literal));
+		return Budget::toAnswer(solver.solve(minisatAssumptions));
+	}
+
+	bool getValue(VariableId id) const override {
+		if (id >= minisatVariables.size() || minisatVariables[id] == Minisat::var_Undef)
+			return false;
+		return solver.modelValue(minisatVariables[id]) == Minisat::l_True;
+	}
+
+	void setBudget(Budget* budget) override {
+		this->budget = budget;
+	}
+
+	Stats getStats() const override {
+		Stats stats;
+		stats.decisions = solver.decisions;
+		stats.propagations = solver.propagations;
+		stats.conflicts = solver.conflicts;
+		return stats;
+	}
+
+	std::string getName() const override {
+		return "Minisat";
+	}
+
+private:
+	Minisat::Solver solver;
+	std::vector<Minisat::Var> minisatVariables;
+	Budget* budget;
+
+	Minisat::Lit getLiteral(const Literal& literal) {
+		if (literal.varId >= minisatVariables.size())
+			minisatVariables.resize(literal.varId + 1, Minisat::var_Undef);
+		if (minisatVariables[literal.varId] == Minisat::var_Undef)
+			minisatVariables[literal.varId] = solver.newVar();
+		return Minisat::mkLit(minisatVariables[literal.varId], literal.neg);
+	}
+};
+
+LogicCircuit::BitSequence solveCnf(SatSolver& solver, const Cnf& cnf) {
+	VariableId variableCount = 0;
+	for (const auto& clause : cnf)
+		for (const auto& literal : clause)
+			variableCount = std::max(variableCount, literal.varId + 1);
+	solver.addCnf(Cnf(cnf));
 	LogicCircuit::BitSequence model;
-	if (result) {
-		model.resize(minisatVariables.size());
-		for (size_t i = 0; i < minisatVariables.size(); i++)
-			model[i] = (solver.modelValue(minisatVariables[i]) == Minisat::l_True);
+	if (solver.solve() == Budget::YES) {
+		model.resize(variableCount);
+		for (VariableId id = 0; id < variableCount; id++)
+			model[id] = solver.getValue(id);
 	}
 	return model;
 }
 
+void testSatSolver(SatSolver& solver) {
+	// sparse variable ids: x10 <-> x42, x3 -> x42
+	Cnf clauses = { { Literal(3, true), Literal(42, false) }, { Literal(10, true), Literal(42, false) },
+	                { Literal(42, true), Literal(10, false) } };
+	auto model = solveCnf(solver, clauses);
+	bool pass = !model.empty() && isCnfModel(clauses, model);
+	pass = pass && solver.solve({ Literal(10, false), Literal(42, true) }) != Budget::YES;
+	pass = pass && solver.solve({ Literal(3, false) }) == Budget::YES && solver.getValue(3) && solver.getValue(42);
+	// assumptions on ids no clause contains
+	pass = pass && solver.solve({ Literal(5, false), Literal(5, true) }) == Budget::NO;
+	pass = pass && solver.solve({ Literal(7, false), Literal(10, false) }) == Budget::YES && solver.getValue(7);
+	pass = pass && solver.solve({ Literal(7, true) }) == Budget::YES && !solver.getValue(7);
+	Cnf pigeonhole;
+	generatePigeonholeCnf(pigeonhole, 4, 3);
+	for (auto& clause : pigeonhole)
+		for (auto& literal : clause)
+			literal.varId += 100;
+	solver.addCnf(std::move(pigeonhole));
+	pass = pass && pigeonhole.empty() && solver.solve() != Budget::YES;
+	SatSolver::Stats stats = solver.getStats();
+	string addInfo = solver.getName() + ", decisions: " + to_string(stats.decisions) +
+		", conflicts: " + to_string(stats.conflicts) + ", flips: " + to_string(stats.flips);
+	printTestItem("SatSolver", pass, addInfo);
+}
+
 void testLogicCircuit(vector<int> archConf, int trainDatasetSize, int testDatasetSize,
 	                  const function<void(LogicCircuit::BitSequence&, LogicCircuit::BitSequence)>& func) {
 	const string TEST_NAME = "Logic Circuit";
@@ -246,7 +962,8 @@ void testLogicCircuit(vector<int> archConf, int trainDatasetSize, int testDatase
 
 	Cnf cnf;
 	lc.getTrainCnf(cnf, trainDataset);
-	auto model = solveCnfWithMinisat(cnf);
+	MinisatSolver solver;
+	auto model = solveCnf(solver, cnf);
 
 	int testPassCount = 0;
 	bool pass = false;
@@ -294,6 +1011,30 @@ int main() {
 			testResolutionGen(3, VAR_NUMBER * ratio, VAR_NUMBER, resLogFile, 5734579 + ratio);
 	}
 	resLogFile.close();
+	testResolutionChain(100, true);
+	testResolutionChain(250, false);
+	testResolutionChain(400, true);
+	testResolutionThreads(132, 22, 4, 5734585);
+	testResolutionThreads(44, 22, 4, 5734581);
+	testResolutionStream(132, 22, 5734585);
+	testResolutionStrategy(Resolution::Options::SATURATION, "saturation");
+	testResolutionStrategy(Resolution::Options::SET_OF_SUPPORT, "set of support");
+	testResolutionStrategy(Resolution::Options::ORDERED, "ordered");
+	testResolutionStrategy(Resolution::Options::POSITIVE_HYPERRESOLUTION, "positive hyperresolution");
+	testResolutionStrategy(Resolution::Options::NEGATIVE_HYPERRESOLUTION, "negative hyperresolution");
+	testResolutionStrategy(Resolution::Options::DAVIS_PUTNAM, "Davis-Putnam");
+	testResolutionStrategy(Resolution::Options::ZRES, "ZRes");
+	testResolutionSelection(Resolution::Options::MASK_ORDER, "mask order");
+	testResolutionSelection(Resolution::Options::WEIGHT, "weight");
+	testResolutionSelection(Resolution::Options::AGE_WEIGHT, "age/weight");
+	testResolutionSelection(Resolution::Options::GOAL_DISTANCE, "goal distance");
+	testResolutionStats(132, 22, 5734585);
+	testResolutionSimplification("((a <-> b) <-> c) <-> (a <-> (b <-> c))", true);
+	testResolutionSimplification("((a -> b) & (b -> c) & (c -> d) & (d -> e) & (e -> f) & (f -> g) & (g -> h) & (h -> i) & (i -> j)) <-> ((~j -> ~i) & (~i -> ~h) & (~h -> ~g) & (~g -> ~f) & (~f -> ~e) & (~e -> ~d) & (~d -> ~c) & (~c -> ~b) & (~b -> ~a))", true);
+	testResolutionSimplification("((a | b | c) & (d | e | f) & (g | h | i) & (j | k | l) & (m | n | o)) <-> ~((~a & ~b & ~c) | (~d & ~e & ~f) | (~g & ~h & ~i) | (~j & ~k & ~l) | (~m & ~n & ~o))", true);
+	testResolutionSimplification("(((a & b) | (c & d)) & ((e & f) | (g & h)) & ((i & j) | (k & l)) & ((m & n) | (o & p))) <-> (~(~a | ~b) | ~(~c | ~d)) & (~(~e | ~f) | ~(~g | ~h)) & (~(~i | ~j) | ~(~k | ~l)) & (~(~m | ~n) | ~(~o | ~p))", true);
+	testResolutionSimplification("(((a & b) -> (c | d)) <-> (e | ~a)) & ((f -> (~g & h)) <-> (i | (j & ~k)))", false);
+	testResolutionZres(5, 1000);
 
 	testForwardChaining();
 
@@ -322,6 +1063,79 @@ int main() {
 	testWalkSat("~(((a | b | c) & (d | e | f) & (g | h | i) & (j | k | l) & (m | n | o)) <-> ~((~a & ~b & ~c) | (~d & ~e & ~f) | (~g & ~h & ~i) | (~j & ~k & ~l) | (~m & ~n & ~o)))", false);
 	testWalkSat("a & b & c & d & e & f & g & h & i & j & k & l & m & n & o & p & q & r & s & t & u & v & w & x & y & z & a1 & b1 & c1 & d1 & e1 & f1 & g1 & h1 & i1 & j1 & k1 & l1 & m1 & n1 & o1 & p1 & q1 & r1 & s1 & t1 & u1 & v1 & w1 & x1 & y1 & z1", true);
 
+	testWalkSatFlips(1000, 250, 1234);
+	testWalkSatFlips(4000, 1000, 4321);
+	testWalkSatHeuristic(WalkSat::WALKSAT, "WalkSAT", 0.5f);
+	testWalkSatHeuristic(WalkSat::PROBSAT, "ProbSAT", 0.f);
+	testWalkSatHeuristic(WalkSat::NOVELTY_PLUS, "Novelty+", 0.5f);
+	testWalkSatHeuristic(WalkSat::PAWS, "PAWS", 0.f);
+	testWalkSatWalkers(1, 0);
+	testWalkSatWalkers(4, 20000);
+
+	testPortfolio("(a | ~b) <-> ((c & d) -> e)", true);
+	testPortfolio("(a & b & c) <-> ~(a & b & c)", false);
+	testPortfolio("~(((a | b | c) & (d | e | f) & (g | h | i) & (j | k | l) & (m | n | o)) <-> ~((~a & ~b & ~c) | (~d & ~e & ~f) | (~g & ~h & ~i) | (~j & ~k & ~l) | (~m & ~n & ~o)))", false);
+	testPortfolio("a & b & c & d & e & f & g & h & i & j & k & l & m & n & o & p & q & r & s & t & u & v & w & x & y & z & a1 & b1 & c1 & d1 & e1 & f1 & g1 & h1 & i1 & j1 & k1 & l1 & m1 & n1 & o1 & p1 & q1 & r1 & s1 & t1 & u1 & v1 & w1 & x1 & y1 & z1", true);
+
+	{
+		Cnf pigeonhole;
+		generatePigeonholeCnf(pigeonhole, 7, 6);
+		testCubeAndConquer(pigeonhole, false, "pigeonhole 7/6");
+		generatePigeonholeCnf(pigeonhole, 6, 6);
+		testCubeAndConquer(pigeonhole, true, "pigeonhole 6/6");
+		for (int i = 0; i < 3; i++)
+			testCubeAndConquerGen(170, 40, 4372 + i);
+	}
+
+	{
+		Cnf clauses;
+		generatePigeonholeCnf(clauses, 6, 5);
+		testDratProof(clauses, DpllCnfSat::FIRST_UNASSIGNED, "pigeonhole 6/5");
+		testDratProof(clauses, DpllCnfSat::MOST_OCCURRENCES, "pigeonhole 6/5, most occurrences");
+		Converter converter;
+		clauses.clear();
+		propositionToCnf(clauses, converter.fromString("~(((a & ~b) | c) <-> (d -> (e & f)) <-> ((a & ~b) | c) <-> (d -> (e & f)))"));
+		testDratProof(clauses, DpllCnfSat::FIRST_UNASSIGNED, "equivalence chain");
+	}
+
+	testBudget();
+	{
+		DpllCnfSat dpll;
+		testSatSolver(dpll);
+		WalkSat walkSat;
+		testSatSolver(walkSat);
+		BitParallelSat bitParallel;
+		testSatSolver(bitParallel);
+		MinisatSolver minisat;
+		testSatSolver(minisat);
+	}
+
+	testModelCounting("(a | b) & (c | d)", "9");
+	testModelCounting("(a & b & c) <-> ~(a & b & c)", "0");
+	testModelCounting("(a -> b) | (c & ~c)", "6");
+	{
+		Cnf clauses;
+		generatePigeonholeCnf(clauses, 6, 6);
+		testModelCountingCnf(clauses, {}, "720", "pigeonhole 6/6");
+		clauses.clear();
+		for (int i = 0; i < 40; i++)
+			clauses.push_back({ Literal(i * 3, false), Literal(i * 3 + 1, false), Literal(i * 3 + 2, false) });
+		testModelCountingCnf(clauses, {}, "6366805760909027985741435139224001", "40 disjoint (a | b | c)");
+		// a <-> (b | c) projected on a: both values of a have models
+		clauses = { { Literal(0, true), Literal(1, false), Literal(2, false) },
+		            { Literal(0, false), Literal(1, true) }, { Literal(0, false), Literal(2, true) } };
+		testModelCountingCnf(clauses, { 0 }, "2", "projection on 1 of 3");
+		testModelCountingCnf(clauses, { 1, 2, 7 }, "8", "projection with absent id");
+	}
+
+	testClassification(400, 3, 3, 2848591);
+	testClassification(200, 6, 8, 2848592);
+	testCounterexamples(200, 4, 4, 2848594);
+	testCounterexamples(100, 7, 9, 2848595);
+	testBdd(100, 6, 10, 2848593);
+	testFingerprint(500, 4, 4, Fingerprint::BITS_64, 2848596);
+	testFingerprint(300, 7, 24, Fingerprint::BITS_512, 2848597);
+	testBddSifting(12);
 	testCnf("(a & b & c) <-> ~(a & b & c)");
 	testCnf("((a & ~b) | c) <-> (d -> (e & f)) <-> ((a & ~b) | c) <-> (d -> (e & f))");
 	testCnf("~(((a & ~b) | c) <-> (d -> (e & f)) <-> ((a & ~b) | c) <-> (d -> (e & f)))");
@@ -8,6 +8,9 @@
 #include "../ForwardChaining.hpp"
 #include "../NaturalDeduction.hpp"
 #include "../CnfSat.hpp"
+#include "../Portfolio.hpp"
+#include "../Bdd.hpp"
+#include "../ThreadPool.hpp"
 
 #include <iostream>
 
@@ -43,28 +46,55 @@ void printConverterSettings(const Converter& converter) {
 	cout << "Parenthesis: " << openingParenthesis << " " << closingParenthesis << endl;
 }
 
-void modelChecking(PropositionSP proposition) {
+void modelChecking(PropositionSP proposition, const Converter& converter) {
 	cout << "Model checking: ";
 	vector<int> variableIds;
 	proposition->getVariableIds(variableIds);
 	const int VARIABLE_NUMBER_THRESHOLD = 30;
-	bool isValid;
-	bool isContradiction;
+	const size_t BDD_MEMORY_LIMIT = 256 << 20; // bytes, SAT solving when exceeded
+	Proposition::Validity validity;
+	NaiveModelChecker::Assignment counterexample;
 	if (variableIds.size() <= VARIABLE_NUMBER_THRESHOLD) {
 		NaiveModelChecker checker;
-		isValid = checker.isValid(proposition);
-		isContradiction = checker.isContradiction(proposition);
+		validity = checker.classify(proposition, &counterexample);
 	}
 	else {
-		isValid = DpllCnfSat::isPropValid(proposition);
-		isContradiction = DpllCnfSat::isPropContradiction(proposition);
+		// the BDD is raced against the SAT portfolio, the first decided answer stops the other one
+		Budget bddBudget;
+		bddBudget.setMemoryLimit(BDD_MEMORY_LIMIT);
+		Budget satBudget;
+		Proposition::Validity bddValidity = Proposition::UNDECIDED;
+		Proposition::Validity satValidity = Proposition::UNDECIDED;
+		{
+			ThreadPool pool(2);
+			pool.submit([&] {
+				bddValidity = Bdd::classifyProp(proposition, bddBudget);
+				if (bddValidity != Proposition::UNDECIDED)
+					satBudget.stop();
+			});
+			pool.submit([&] {
+				satValidity = PortfolioSat::classifyProp(proposition, satBudget);
+				if (satValidity != Proposition::UNDECIDED)
+					bddBudget.stop();
+			});
+			pool.wait();
+		}
+		validity = bddValidity != Proposition::UNDECIDED ? bddValidity : satValidity;
 	}
-	if (isValid)
+	if (validity == Proposition::VALID)
 		cout << "valid";
-	else if (isContradiction)
+	else if (validity == Proposition::CONTRADICTION)
 		cout << "contradiction";
-	else
+	else {
 		cout << "contingent";
+		if (!counterexample.empty()) {
+			vector<string> variables;
+			converter.getStringsForVariables(variables);
+			cout << ", false for ";
+			for (size_t i = 0; i < counterexample.size(); i++)
+				cout << (i == 0 ? "" : ", ") << variables[counterexample[i].first] << " = " << counterexample[i].second;
+		}
+	}
 	cout << endl;
 }
 
@@ -96,7 +126,7 @@ int main() {
 		else {
 			PropositionSP proposition = converter.fromString(str);
 			if (proposition) {
-				modelChecking(proposition);
+				modelChecking(proposition, converter);
 				resolution(proposition);
 			}
 			else